@@ -6,10 +6,13 @@ the desired position for 1 second. */
 // NB: CCW is +ve
 
 #include "Arduino.h"
+// Time Events in Microseconds so the Sensing and Control Loops can Run Well
+// Above 1kHz:
+#define SCHEDULE_MICROS
+#include "Schedule.h" // (first, so the HAL can record to a SensorLog)
 #include "HAL.h"
 #include "Sensing.h"
 #include "Motion.h"
-#include "Schedule.h"
 //#include "Comm.h"
 
 #define sgn(x) ( (x==0) ? 0 : abs(x) / (x) )
@@ -23,7 +26,11 @@ bool holding_position = false; // Whether Currently Holding the Position Set by
 unsigned long let_go_time = 0; // Time when the user last let go
 
 void setup(){
+#ifdef RECORD_SENSORS
+  Serial.begin(115200);
+#else
   Serial.begin(9600);
+#endif
   initHAL();
   // initComm(); // -TODO: Implement I2C Communications for Sound Sync.
 
@@ -33,8 +40,10 @@ void setup(){
 
 void schedule(){
   /** Perform Basic Life-Line Tasks: **/
-  sch->ALWAYS->DO(updateSensors);
-  sch->ALWAYS->DO(updateMotion);
+  // Take one Reading per Check however Late (catching up would feed the same
+  // angles into the lag average over and over):
+  sch->ALWAYS->onOverrun(TimedEvent::SKIP_MISSED)->critical()->DO(updateSensors);
+  sch->ALWAYS->critical()->DO(updateMotion);
 
   /** Coordinate Responses: **/
   // Enter Follower Mode:
@@ -63,12 +72,19 @@ void schedule(){
   });
 
   /** Give Status Updates: **/
-  // Plot Load on Actuator:
-  sch->EVERY(200)->do_([](){
+#ifdef RECORD_SENSORS
+  // Serial only Carries the Log (one flush sends everything, so a late one
+  // needn't be repeated):
+  sch->EVERY(20 * SCHEDULE_TICKS_PER_MS)->onOverrun(TimedEvent::SKIP_MISSED)->do_([](){ sensor_log.flush(Serial); });
+#else
+  // Plot Load on Actuator (once when late, rather than a burst of the same
+  // reading):
+  sch->EVERY(200 * SCHEDULE_TICKS_PER_MS)->onOverrun(TimedEvent::REALIGN)->do_([](){
     Serial.print(Sensors.diff);
     Serial.print(",");
     Serial.println(torque());
   });
+#endif
 } // #schedule
 
 void loop(){
@@ -10,12 +10,26 @@
 // Baud: 115200
 // Erase: Sketch Only
 
+#ifndef _CFCT_ // On the Host, Tests Include Stand-ins for these First (see PeekABoo/Behavior/HostStubs.h)
 #include <Encoder.h>
+#include <AccelStepper.h>
+#endif
 #define ENC_STEPS_PER_REV 80.0
 Encoder EncO(13,12); // Output Encoder
 Encoder EncI(10,9); // Input Encoder
 
-#include <AccelStepper.h>
+// Define RECORD_SENSORS to Stream every Encoder Read out over Serial as a
+// SensorLog (see Schedule.h) for Replaying on the Host:
+#ifdef RECORD_SENSORS
+SensorLog sensor_log;
+#define RECORDED(channel, x) sensor_log.record(channel, x)
+#else
+#define RECORDED(channel, x) (x)
+#endif
+// Log Channels:
+#define CH_ENC_O 2
+#define CH_ENC_I 3
+
 #define STP 1
 #define DIR 3
 #define EN 8
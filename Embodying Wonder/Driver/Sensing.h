@@ -16,12 +16,12 @@ struct SensorsType{
 
 // Returns the Output Angle from the Encoder in Degrees
 float outputAng(){
-  return 360.0 * EncO.read() / ENC_STEPS_PER_REV;
+  return 360.0 * RECORDED(CH_ENC_O, EncO.read()) / ENC_STEPS_PER_REV;
 } // #outputAng
 
 // Returns the Input Angle from the Encoder in Degrees
 float inputAng(){
-  return -360.0 * EncI.read() / ENC_STEPS_PER_REV / GEAR_RATIO;
+  return -360.0 * RECORDED(CH_ENC_I, EncI.read()) / ENC_STEPS_PER_REV / GEAR_RATIO;
 } // #outputAng
 
 // Computes the Torque Loading the Actuator in N-m. This is an expensive
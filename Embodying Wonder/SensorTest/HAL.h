@@ -9,7 +9,9 @@
 // Baud: 115200
 // Erase: Sketch Only
 
+#ifndef _CFCT_ // On the Host, Tests Include Stand-ins for these First (see PeekABoo/Behavior/HostStubs.h)
 #include <Encoder.h>
+#endif
 #define ENC_STEPS_PER_REV 80.0
 Encoder EncO(13,12); // Output Encoder
 Encoder EncI(10,9); // Input Encoder
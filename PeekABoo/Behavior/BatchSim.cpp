@@ -0,0 +1,367 @@
+#ifdef _CFCT_ // Compiling for g++ Testing (keeps avr-gcc from bugging about this file)
+/* Host Batch Simulator for Tuning Sensor Thresholds without Reflashing.
+ * Builds one Schedule per parameter set (and random seed), each running the
+ * same detection logic as the sketches against mocked sensors which play out
+ * a randomized series of people walking up, touching the robot, and
+ * grabbing the handle. Every Schedule runs on virtual time, and they're all
+ * spread across the cores by a work-stealing WorkPool. The metrics for each
+ * configuration (over all its seeds) are printed as CSV:
+ *  - PeekABoo (Behavior/HAL.h): %threshold% of #personPresent and CAP_THRESH
+ *  - SEA Driver (Embodying Wonder/Driver.ino): DIFF_THRESH
+ * The sketches' own code keeps its state in globals, so it can't run on many
+ * schedules at once. Before the sweep, the mocked logic is run side by side
+ * with #personPresent of HAL.h and #updateSensors of the Driver's Sensing.h
+ * (compiled against HostStubs.h) on the same reads, and it stops there if
+ * they ever disagree.
+ * Build: g++ -std=gnu++11 -D_CFCT_ -O2 -pthread -o batch BatchSim.cpp
+ * Usage: ./batch [seeds per configuration] [simulated minutes per run]
+ */
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#define SCHEDULE_VIRTUAL_CLOCK
+#define SCHEDULE_THREADS
+#include "Schedule.h"
+unsigned long millis(){ return VirtualClock::now(); }
+#include "HostStubs.h"
+#include "HAL.h"
+#define initHAL initDriverHAL // (both HALs have one)
+#include "../../Embodying Wonder/Driver/Sensing.h"
+#undef initHAL
+
+#define pl(x) std::cout << x << std::endl
+
+/* Small Deterministic Random Number Generator (xorshift32), One per Run. */
+struct Random{
+    uint32_t s;
+    Random(uint32_t seed) : s{(uint32_t)(seed * 2654435761UL + 1)} {};
+    uint32_t next(){
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        return s;
+    }
+    // Uniform in [lo, hi):
+    long range(long lo, long hi){ return lo + (long)(this->next() % (uint32_t)(hi - lo)); }
+    // Roughly Normal (sum of uniforms) with the Given Mean and Spread:
+    long noisy(long mean, long spread){ return mean + this->range(-spread, spread + 1) / 2 + this->range(-spread, spread + 1) / 2; }
+    bool chance(unsigned int per_mille){ return this->next() % 1000 < per_mille; }
+};
+
+/*
+ * Mocked World of a PeekABoo: people come and go every so often (sometimes
+ * touching its hands while they're there), and the sonar picks up the odd
+ * spurious close echo while nobody is.
+ */
+struct PeekWorld{
+    unsigned int threshold; // of #personPresent [cm]
+    unsigned int cap_thresh; // CAP_THRESH
+    Random rng;
+    // Scenario:
+    unsigned long visit_start = 0, visit_end = 0; // Current (or Next) Visit [ms]
+    unsigned long touch_start = 0, touch_end = 0; // Current (or Next) Touch [ms]
+    Signal<float>* distance = nullptr; // Sonar, Sampled Once per Pass (as in HAL.h)
+    // State of #personPresent:
+    unsigned int oldest_value = -1, last_value = -1;
+    unsigned long t_last_check = 0;
+    // Metrics:
+    unsigned long visits = 0, visits_seen = 0, false_peeks = 0, latency_total = 0;
+    unsigned long touches = 0, touches_felt = 0, false_touches = 0;
+    bool visit_seen = false, touch_felt = false;
+
+    PeekWorld(unsigned int t, unsigned int c, uint32_t seed) : threshold{t}, cap_thresh{c}, rng{seed} {
+        this->planVisit(0);
+    }
+
+    bool visiting(){ return millis() >= this->visit_start && millis() < this->visit_end; }
+    bool touching(){ return millis() >= this->touch_start && millis() < this->touch_end; }
+
+    /* Plans the Next Visit after Time %t% (and maybe a Touch during it). */
+    void planVisit(unsigned long t){
+        this->visit_start = t + this->rng.range(5000, 40000);
+        this->visit_end = this->visit_start + this->rng.range(1500, 15000);
+        this->touch_start = this->touch_end = 0;
+        if(this->rng.chance(600)){
+            this->touch_start = this->visit_start + this->rng.range(500, this->visit_end - this->visit_start);
+            this->touch_end = this->touch_start + this->rng.range(100, 1500);
+        }
+        this->visit_seen = this->touch_felt = false;
+    }
+
+    /* Moves the Scenario along to the Current Time (called every pass). */
+    void update(){
+        if(millis() >= this->visit_end){
+            this->visits++;
+            this->visits_seen += this->visit_seen;
+            if(this->touch_start){
+                this->touches++;
+                this->touches_felt += this->touch_felt;
+            }
+            this->planVisit(this->visit_end);
+        }
+    }
+
+    /* Sonar Reading [cm] (never closer than the 2cm an HC-SR04 can see). */
+    float sonar(){
+        long cm;
+        if(this->visiting()){
+            cm = this->rng.noisy(this->touching() ? 8 : 22, 16);
+        } else{
+            cm = this->rng.chance(20) ? this->rng.range(5, 40) : this->rng.noisy(90, 30);
+        }
+        return (cm < 2 ? 2 : cm) + this->rng.range(0, 100) / 100.0f;
+    }
+
+    /* Raw Capacitive Sensor Reading. */
+    long capacitive(){
+        if(this->touching()){ return this->rng.noisy(45, 30); }
+        return this->rng.chance(5) ? this->rng.range(10, 60) : this->rng.noisy(8, 12);
+    }
+
+    /* Same as #personPresent in HAL.h (with %threshold% for its 25cm): true
+     only on the passes which check the sonar (every 125ms or so). */
+    bool personPresent(){
+        bool present = false;
+        if(millis() - this->t_last_check > 125){
+            this->t_last_check = millis();
+            present = this->distance->read() < this->threshold && this->last_value < this->threshold && this->oldest_value < this->threshold;
+            this->oldest_value = this->last_value;
+            this->last_value = this->distance->read();
+        }
+        return present;
+    }
+
+    void peeked(){
+        if(!this->visiting()){
+            this->false_peeks++;
+        } else if(!this->visit_seen){
+            this->visit_seen = true;
+            this->latency_total += millis() - this->visit_start;
+        }
+    }
+
+    void felt(){
+        if(this->touching()){
+            this->touch_felt = true;
+        } else{
+            this->false_touches++;
+        }
+    }
+};
+
+/*
+ * Mocked World of the SEA Driver: the motor sweeps the input disk back and
+ * forth (with the output trailing it through the bands), now and then someone
+ * grabs the handle and twists the output away from it, and the encoders only
+ * count whole steps of each.
+ */
+struct DriverWorld{
+    int diff_thresh; // DIFF_THRESH
+    Random rng;
+    unsigned long grab_start = 0, grab_end = 0; // Current (or Next) Grab [ms]
+    int grab_diff = 0; // Twist during the Grab [deg]
+    long enc_o = 0, enc_i = 0; // Encoder Counts
+    // State of Sensing.h (Sensors):
+    float input_ang = 0.0, output_ang = 0.0, diff = 0.0, lag_sum = 0.0;
+    unsigned long lag_count = 0;
+    // Metrics:
+    unsigned long grabs = 0, grabs_followed = 0, false_follows = 0, moves = 0;
+    bool grab_followed = false;
+
+    DriverWorld(int d, uint32_t seed) : diff_thresh{d}, rng{seed} {
+        this->planGrab(0);
+    }
+
+    bool grabbed(){ return millis() >= this->grab_start && millis() < this->grab_end; }
+
+    void planGrab(unsigned long t){
+        this->grab_start = t + this->rng.range(3000, 20000);
+        this->grab_end = this->grab_start + this->rng.range(500, 5000);
+        this->grab_diff = this->rng.range(8, 60) * (this->rng.chance(500) ? 1 : -1);
+        this->grab_followed = false;
+    }
+
+    /* Moves the Scenario along to the Current Time and Sets the Encoder Counts
+     (the sweep takes 160s each way at the stepper's top speed). */
+    void sense(){
+        if(millis() >= this->grab_end){
+            this->grabs++;
+            this->grabs_followed += this->grab_followed;
+            this->planGrab(this->grab_end);
+        }
+        unsigned long t = millis() % 320000;
+        int dir = t < 160000 ? 1 : -1;
+        float input = dir > 0 ? -180.0f + 360.0f * t / 160000 : 180.0f - 360.0f * (t - 160000) / 160000;
+        float output = input - 6 * dir + this->rng.noisy(0, 4); // Trailing the Input
+        if(this->rng.chance(30)){ output += this->rng.range(-20, 21); } // Jolts from the Motion
+        if(this->grabbed()){ output += this->grab_diff; }
+        this->enc_o = lround(output * ENC_STEPS_PER_REV / 360.0);
+        this->enc_i = lround(-input * ENC_STEPS_PER_REV * GEAR_RATIO / 360.0);
+    }
+
+    /* Same as #updateSensors in Sensing.h (on %enc_o% and %enc_i%). */
+    void updateSensors(){
+        this->input_ang = -360.0 * this->enc_i / ENC_STEPS_PER_REV / GEAR_RATIO;
+        this->output_ang = 360.0 * this->enc_o / ENC_STEPS_PER_REV;
+        this->lag_sum += this->output_ang - this->input_ang;
+        this->lag_count += 1;
+        this->diff = this->output_ang - this->input_ang - this->lag_sum / this->lag_count;
+    }
+
+    void follow(){
+        this->moves++;
+        if(this->grabbed()){
+            this->grab_followed = true;
+        } else{
+            this->false_follows++;
+        }
+    }
+
+    void letGo(){ this->moves++; }
+};
+
+/* Runs the PeekABoo Logic of Behavior.ino (peek when someone's there, chuckle
+ when touched) on its own Schedule. */
+void runPeek(PeekWorld* w, unsigned long duration){
+    VirtualClock::set(0);
+    Schedule* sch = new Schedule();
+    sch->ALWAYS->do_([w](){ w->update(); });
+    w->distance = sch->sample([w](){ return w->sonar(); });
+    Signal<bool>* touch = sch->sample([w](){ return w->capacitive() > (long) w->cap_thresh; });
+    sch->when([w](){ return w->personPresent(); })->do_([w](){ w->peeked(); });
+    sch->when([touch](){ return touch->read(); })->do_([w](){ w->felt(); });
+    sch->simulate(duration, 25);
+    delete sch;
+}
+
+/* Runs the Follower Logic of Driver.ino on its own Schedule (like it, only
+ following twists which push the output the positive way). */
+void runDriver(DriverWorld* w, unsigned long duration){
+    VirtualClock::set(0);
+    Schedule* sch = new Schedule();
+    sch->ALWAYS->onOverrun(TimedEvent::SKIP_MISSED)->critical()->do_([w](){ w->sense(); w->updateSensors(); });
+    sch->when([w](){ return w->diff > w->diff_thresh; })->do_([w](){ w->follow(); });
+    sch->when([w](){ return w->diff < w->diff_thresh; })->do_([w](){ w->letGo(); });
+    sch->simulate(duration, 5);
+    delete sch;
+}
+
+// Worlds being Checked against the Sketches (see #checkSketches):
+PeekWorld* checked_peek;
+DriverWorld* checked_driver;
+unsigned long disagreements = 0, presences = 0, follows = 0;
+
+/* Runs the Mocked Logic Side by Side with the Sketches' Own for %duration%
+ ms, both Reading the Same Sensors every Pass: PeekWorld#personPresent
+ against #personPresent of HAL.h (with its 25cm, on its own Schedule and
+ sonar Signal), and DriverWorld#updateSensors against #updateSensors of
+ Sensing.h. Returns the Number of Passes they Disagreed on. */
+unsigned long checkSketches(unsigned long duration){
+    VirtualClock::set(0);
+    checked_peek = new PeekWorld(25, CAP_THRESH, 1);
+    checked_peek->distance = distance;
+    UltraSonicDistanceSensor::reading = [](){ return checked_peek->sonar(); };
+    sch->ALWAYS->do_([](){
+        checked_peek->update();
+        bool present = personPresent();
+        disagreements += present != checked_peek->personPresent();
+        presences += present;
+    });
+    sch->simulate(duration, 25);
+
+    VirtualClock::set(0);
+    checked_driver = new DriverWorld(12, 1);
+    EncO.reading = [](){ return checked_driver->enc_o; };
+    EncI.reading = [](){ return checked_driver->enc_i; };
+    Schedule* driver = new Schedule();
+    driver->ALWAYS->critical()->do_([](){
+        checked_driver->sense();
+        checked_driver->updateSensors();
+        updateSensors();
+        disagreements += Sensors.diff != checked_driver->diff;
+        follows += Sensors.diff > 12;
+    });
+    driver->simulate(duration, 5);
+    delete driver;
+    delete checked_peek;
+    delete checked_driver;
+    return disagreements;
+}
+
+int main(int argc, char** argv){
+    unsigned int seeds = argc > 1 ? atoi(argv[1]) : 4;
+    unsigned long duration = (argc > 2 ? atol(argv[2]) : 5) * 60000UL;
+
+    if(checkSketches(duration)){
+        pl("# mocked logic disagrees with the sketches on " << disagreements << " passes");
+        return 1;
+    }
+    pl("# mocked logic matches the sketches (" << presences << " presences, " << follows << " passes following)");
+
+    std::vector<PeekWorld*> peeks;
+    for(unsigned int t = 10; t <= 60; t += 2){
+        for(unsigned int c = 5; c <= 60; c += 5){
+            for(unsigned int s = 0; s < seeds; s++){
+                peeks.push_back(new PeekWorld(t, c, s + 1));
+            }
+        }
+    }
+    std::vector<DriverWorld*> drivers;
+    for(int d = 2; d <= 40; d++){
+        for(unsigned int s = 0; s < seeds; s++){
+            drivers.push_back(new DriverWorld(d, s + 1));
+        }
+    }
+
+    unsigned int cores = std::thread::hardware_concurrency();
+    WorkPool pool(cores > 0 ? cores : 1);
+    auto start = std::chrono::steady_clock::now();
+    for(std::vector<PeekWorld*>::size_type i = 0; i != peeks.size(); i++){
+        PeekWorld* w = peeks[i];
+        pool.submit([w, duration](){ runPeek(w, duration); });
+    }
+    for(std::vector<DriverWorld*>::size_type i = 0; i != drivers.size(); i++){
+        DriverWorld* w = drivers[i];
+        pool.submit([w, duration](){ runDriver(w, duration); });
+    }
+    pool.wait();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    pl("threshold,cap_thresh,visits,seen_pct,false_peeks_per_h,latency_ms,touches,felt_pct,false_touches_per_h");
+    double hours = seeds * duration / 3600000.0;
+    for(std::vector<PeekWorld*>::size_type i = 0; i < peeks.size(); i += seeds){
+        unsigned long visits = 0, seen = 0, false_peeks = 0, latency = 0, touches = 0, felt = 0, false_touches = 0;
+        for(unsigned int s = 0; s < seeds; s++){
+            PeekWorld* w = peeks[i + s];
+            visits += w->visits; seen += w->visits_seen; false_peeks += w->false_peeks; latency += w->latency_total;
+            touches += w->touches; felt += w->touches_felt; false_touches += w->false_touches;
+        }
+        pl(peeks[i]->threshold << ',' << peeks[i]->cap_thresh << ',' << visits << ','
+            << (visits ? 100.0 * seen / visits : 0) << ',' << false_peeks / hours << ','
+            << (seen ? latency / seen : 0) << ',' << touches << ','
+            << (touches ? 100.0 * felt / touches : 0) << ',' << false_touches / hours);
+    }
+    pl("");
+    pl("diff_thresh,grabs,followed_pct,false_follows_per_h,moves_per_h");
+    for(std::vector<DriverWorld*>::size_type i = 0; i < drivers.size(); i += seeds){
+        unsigned long grabs = 0, followed = 0, false_follows = 0, moves = 0;
+        for(unsigned int s = 0; s < seeds; s++){
+            DriverWorld* w = drivers[i + s];
+            grabs += w->grabs; followed += w->grabs_followed; false_follows += w->false_follows; moves += w->moves;
+        }
+        pl(drivers[i]->diff_thresh << ',' << grabs << ',' << (grabs ? 100.0 * followed / grabs : 0) << ','
+            << false_follows / hours << ',' << moves / hours);
+    }
+    pl("");
+    pl("# " << peeks.size() + drivers.size() << " runs of " << duration / 60000 << " min on "
+        << pool.size() << " threads in " << secs << "s");
+    for(std::vector<PeekWorld*>::size_type i = 0; i != peeks.size(); i++){
+        delete peeks[i];
+    }
+    for(std::vector<DriverWorld*>::size_type i = 0; i != drivers.size(); i++){
+        delete drivers[i];
+    }
+    return 0;
+}
+#endif
@@ -44,28 +44,38 @@
 
 #define RESTING_EYE_LEVEL 37
 
-void wakeUp(){
-  blink(750);
-  **(Robot.eyes_open) = true;
+void wakeUp(Task* task){
+  TASK_BEGIN;
+  AWAIT(blink(750));
+  Robot.eyes_open.set(true);
   moveEyeLidsTo(RESTING_EYE_LEVEL);
   moveStalks(100);
-  **(Robot.awake) = true;
+  Robot.awake.set(true);
+  TASK_END;
 } // #wakeUp
 
 void setup(){
+#ifdef RECORD_SENSORS
+  Serial.begin(115200);
+  sch->EVERY(20)->do_([](){ sensor_log.flush(Serial); }); // Serial only Carries the Log
+#else
   Serial.begin(9600);
+#endif
 
   initHAL();
   moveStalks(0);
   moveHands(0);
   eyeLids(100); // Eyes Start Closed (call this before the scheduler turns on)
 
-  sch->WHEN(!**(Robot.awake) && personPresent())->do_(wakeUp);
+  sch->WHEN(!Robot.awake.get() && personPresent())->resumable(wakeUp);
 
   sch
-    ->WHEN( **(Robot.awake) )
+    ->WHEN( Robot.awake.get() )
+    ->reactive()
     ->do_([](){
+#ifndef RECORD_SENSORS
       Serial.println("I'm Awake.");
+#endif
       chuckle();
       moveEyeLidsTo(RESTING_EYE_LEVEL);
       sch->IN(1200)->do_([](){
@@ -74,24 +84,29 @@ void setup(){
       });
     });
 
-  sch->EVERY_WHILE( 1500, **(Robot.eyes_covered) )->do_(togglePeek);
+  sch->EVERY_WHILE( 1500, Robot.eyes_covered.get() )->do_(togglePeek);
 
   sch
-    ->WHEN( **(Robot.eyes_covered) && personPresent() )
-    ->do_([](){
+    ->WHEN( Robot.eyes_covered.get() && personPresent() )
+    ->resumable([](Task* task){
+      TASK_BEGIN;
       uncoverEyes();
-      chuckle();
-      chuckle();
+      AWAIT(chuckle());
+      AWAIT(chuckle());
       moveEyeLidsTo(RESTING_EYE_LEVEL);
       moveStalks(100);
+      TASK_END;
     });
 
   sch
     ->WHEN(touched())
-    ->do_([](){
+    ->reactive()
+    ->resumable([](Task* task){
+      TASK_BEGIN;
       coverEyes();
-      delay(500);
+      WAIT(500);
       moveStalks(0);
+      TASK_END;
     });
 } // #setup
 
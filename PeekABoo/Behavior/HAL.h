@@ -1,19 +1,36 @@
 #ifndef HAL_H
 #define HAL_H
+#ifndef _CFCT_ // On the Host, Tests Include Stand-ins for these First (see HostStubs.h)
 #include <Wire.h>
 #include <CapacitiveSensor.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 #include <Servo.h>
 #include <HCSR04.h>
+#endif
 #include "Schedule.h"
 
 Schedule* sch = new Schedule();
 
+// Define RECORD_SENSORS to Stream every Sensor Read out over Serial as a
+// SensorLog (see Schedule.h) for Replaying on the Host (ReplayTest.cpp):
+#ifdef RECORD_SENSORS
+SensorLog sensor_log;
+#define RECORDED(channel, x) sensor_log.record(channel, x)
+#else
+#define RECORDED(channel, x) (x)
+#endif
+// Log Channels:
+#define CH_DIST 0
+#define CH_CAP 1
+
 // Ultrasound Sensing Pins:
 #define P_ECHO 12
 #define P_TRIG 11
 UltraSonicDistanceSensor sonar(P_TRIG, P_ECHO);
+// Each Ping Blocks for up to Tens of ms, so Only Ping Once per Pass (no matter
+// how many conditions check the distance):
+Signal<float>* distance = sch->sample([](){ return RECORDED(CH_DIST, sonar.measureDistanceCm()); });
 
 // Capacitive Sensor on Hands:
 #define CAP_PUSH A0
@@ -21,6 +38,9 @@ UltraSonicDistanceSensor sonar(P_TRIG, P_ECHO);
 // Threshold Value for Detecting a Touch:
 #define CAP_THRESH 20
 CapacitiveSensor capsens = CapacitiveSensor(CAP_PUSH,CAP_SENS);
+// Touch Reading, Sampled Once per Pass:
+// (the raw reading is recorded, so replays can try other thresholds)
+Signal<bool>* touch = sch->sample([](){ return RECORDED(CH_CAP, capsens.capacitiveSensor(30)) > CAP_THRESH; });
 
 
 // Servo Motor Pins:
@@ -39,25 +59,25 @@ Adafruit_SSD1306 display(OLED_RESET);
 
 // STATE VARIABLES:
 struct RobotType{
-  ActionState awake = new_ActionState(false);
-  ActionState eyes_open = new_ActionState(false);
-  ActionState eyes_covered = new_ActionState(false);
+  State<bool> awake;
+  State<bool> eyes_open;
+  State<bool> eyes_covered;
 } Robot;
 
 // OPERATIONS VARIABLES:
 int currentEyePercent = 100;
 
 // EMOTION PRIMITIVES:
-// Chuckles slightly by inverting the eyes three times and moving eye stalks up and down.
-void chuckle();
+// Chuckles slightly by inverting the eyes three times and moving eye stalks up and down. Returns when it's done.
+ActionState chuckle();
 // Opens/Close the Eyes by Drawing them at the Given Percent Closed where 0 is fully open and 1 is fully closed
 void eyeLids(int);
 // Moves the Eye Lid Smoothly and Quickly to the Given Eye Level.
 void moveEyeLidsTo(int);
 // Blinks Both Eyes by Lowering and Raising the Eye Level (Lids) Quickly. Returns Eye Lids to their initial state.
-void blink();
+ActionState blink();
 // Blinks Both Eyes by Lowering and Raising the Eye Level (Lids) taking the Given Time to Complete. Returns Eye Lids to their initial state.
-void blink(int);
+ActionState blink(int);
 
 // MOTION PRIMITIVES:
 // Moves stalks to %percent% of the way from the bottom of their swing where 0% is their lowest position and 100% is their highest
@@ -88,7 +108,7 @@ bool personPresent();
 
 // HELPER FUNCTIONS:
 // Performs a Basic Blink/Squint by Inverting the Screen then Uninverting Shortly Later:
-bool** invertBlink();
+ActionState invertBlink();
 // Commands the Given Servo to the Given Percent of its Range from minAng to maxAng
 void commandServo(Servo, int, int, int);
 
@@ -106,42 +126,53 @@ void initHAL(){
 } // #initHAL
 
 // Blinks Both Eyes by Lowering and Raising the Eye Level (Lids) Quickly. Returns Eye Lids to their initial state.
-void blink(){ blink(0); }
+ActionState blink(){ return blink(0); }
 // Blinks Both Eyes by Lowering and Raising the Eye Level (Lids) taking the Given Time to Complete. Returns Eye Lids to their initial state.
-void blink(int t){
+ActionState blink(int t){
   static const char step = 5;
   int initState = currentEyePercent;
   int waitTime = step * t / 200;
-
-  int i;
-  for(i=initState; i<100; i+=step){ // Close Eyes First
-    delay(waitTime);
-    eyeLids(i);
-  }
-  for(i=100; i>0; i-=step){ // Then Open
-    delay(waitTime);
-    eyeLids(i);
-  }
-  for(i=0; i<=initState; i+=step){ // Return to Initial State
-    delay(waitTime);
-    eyeLids(i);
-  }
+  int i = 0;
+
+  return sch->spawn([initState, waitTime, i](Task* task) mutable {
+    TASK_BEGIN;
+    for(i=initState; i<100; i+=step){ // Close Eyes First
+      WAIT(waitTime);
+      eyeLids(i);
+    }
+    for(i=100; i>0; i-=step){ // Then Open
+      WAIT(waitTime);
+      eyeLids(i);
+    }
+    for(i=0; i<=initState; i+=step){ // Return to Initial State
+      WAIT(waitTime);
+      eyeLids(i);
+    }
+    TASK_END;
+  });
 } // #blink
 
-bool** invertBlink(){
-  display.invertDisplay(true);
-  delay(250);
-  display.invertDisplay(false);
-  delay(250);
-  return new_ActionState(true); // Used to spawn an event - returns for compatibility
+ActionState invertBlink(){
+  return sch->spawn([](Task* task){
+    TASK_BEGIN;
+    display.invertDisplay(true);
+    WAIT(250);
+    display.invertDisplay(false);
+    WAIT(250);
+    TASK_END;
+  });
 } // #invertBlink
 
 // Chuckles slightly by inverting the eyes three times and moving eye stalks up and down.
-void chuckle(){
-  invertBlink();
-  moveStalks(80);
-  invertBlink();
-  moveStalks(20);
+ActionState chuckle(){
+  return sch->spawn([](Task* task){
+    TASK_BEGIN;
+    AWAIT(invertBlink());
+    moveStalks(80);
+    AWAIT(invertBlink());
+    moveStalks(20);
+    TASK_END;
+  });
 } // #chuckle
 
 // Opens/Close the Eyes by Drawing them at the Given Percent Closed where 0 is fully open and 1 is fully closed.
@@ -165,7 +196,7 @@ void eyeLids(int percent){
   // Determine whether lid-color lines need to be added or removed:
   unsigned char color = (currentEyePercent > percent) ? LID_COLOR : !LID_COLOR;
   // Change Eye-Level
-  char dir = abs(targ_lvl-curr_lvl)/(targ_lvl-curr_lvl);
+  char dir = (targ_lvl > curr_lvl) ? 1 : -1; // (abs(d)/d divides by zero when it's already there)
   while(curr_lvl != targ_lvl){
     curr_lvl += dir;
     display.drawLine(0,curr_lvl, w2h*curr_lvl,0, color);
@@ -179,7 +210,7 @@ void eyeLids(int percent){
 void moveEyeLidsTo(int targ_percent){
   // Change Eye-Level
   static const int step = 10;
-  char dir = abs(targ_percent-currentEyePercent)/(targ_percent-currentEyePercent);
+  char dir = (targ_percent > currentEyePercent) ? 1 : -1;
   int curr_target = currentEyePercent;
   while(dir * (targ_percent-currentEyePercent) > 0){
     curr_target += dir*step;
@@ -208,12 +239,12 @@ void moveHands(int percent){ moveHandLeft(percent); moveHandRight(percent); }
 // Moves both hands over the eyes.
 void coverEyes(){
   moveHands(100);
-  **(Robot.eyes_covered) = true;
+  Robot.eyes_covered.set(true);
 } // #coverEyes
 // Uncovers its eyes.
 void uncoverEyes(){
   moveHands(0);
-  **(Robot.eyes_covered) = false;
+  Robot.eyes_covered.set(false);
 } // #uncoverEyes
 
 // Moves hands slightly out of the way of the eyes on first call, on second call it covers them up
@@ -229,12 +260,12 @@ void togglePeek(){
 
 // Returns the distance to the nearest object in front of the robot based on ultrasound.
 float dist(){
-  return sonar.measureDistanceCm();
+  return distance->read();
 } // #dist
 
 // Returns Whether the Robot is Currently Being Touched on its Hands.
 bool touched(){
-  return capsens.capacitiveSensor(30) > 20;
+  return touch->read();
 } // #touched
 
 // Determines if a person is actually present (and not noise)
@@ -0,0 +1,130 @@
+#ifdef _CFCT_ // Compiling for g++ Testing (keeps avr-gcc from bugging about this file)
+/* Host Stand-ins for the Arduino Core and the Libraries the Sketches Use, so
+ * their own HAL and behavior code can be compiled and run on the host (see
+ * ReplayTest.cpp and BatchSim.cpp). Include this before the HAL (which skips
+ * its library includes when compiled for testing) and define millis().
+ * Sensors read whatever the program hooks up to them (nothing hooked up reads
+ * as nothing there), and every command given to an actuator or the display
+ * is passed to %host_command% (if set) so the program can trace what the
+ * sketch does.
+ */
+#ifndef HOST_STUBS_H
+#define HOST_STUBS_H
+#include <cmath>
+#include <cstdlib>
+#include <stdint.h>
+#include <vector>
+
+unsigned long millis();
+
+// Arduino Core:
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define A0 14
+#define A1 15
+#define constrain(x, lo, hi) ((x) < (lo) ? (lo) : ((x) > (hi) ? (hi) : (x)))
+#define sq(x) ((x) * (x))
+inline void pinMode(int, int){ }
+inline void digitalWrite(int, int){ }
+
+// Receives every Command Given to the Stand-ins: %device% is 'S' for a Servo
+// (%value% is pin * 1000 + angle), 'I' for Inverting the Display, 'D' for
+// Pushing a Frame to it (%value% is the number of lines drawn since the last)
+// and 'M' for a Stepper Target (in steps):
+void (*host_command)(char device, long value) = nullptr;
+inline void hostCommand(char device, long value){
+    if(host_command){ host_command(device, value); }
+} // #hostCommand
+
+/* Serial Port which Keeps Every Byte Written to it (text is dropped). */
+struct HostSerial{
+    std::vector<uint8_t> bytes;
+    void begin(unsigned long){ }
+    void write(uint8_t b){ this->bytes.push_back(b); }
+    template <typename T> void print(T){ }
+    template <typename T> void println(T){ }
+    void println(){ }
+} Serial;
+
+// <HCSR04.h>:
+class UltraSonicDistanceSensor{
+public:
+    static float (*reading)(); // Supplies Each Distance Read [cm]
+    UltraSonicDistanceSensor(int, int){ }
+    float measureDistanceCm(){ return reading ? reading() : -1.0f; } // -1: Nothing in Range
+};
+float (*UltraSonicDistanceSensor::reading)() = nullptr;
+
+// <CapacitiveSensor.h>:
+class CapacitiveSensor{
+public:
+    static long (*reading)(); // Supplies Each Raw Reading
+    CapacitiveSensor(int, int){ }
+    long capacitiveSensor(int){ return reading ? reading() : 0; }
+};
+long (*CapacitiveSensor::reading)() = nullptr;
+
+// <Servo.h> (copies keep their pin, so commands through a copy still count):
+class Servo{
+public:
+    void attach(int p){ this->pin = p; }
+    void write(int angle){ hostCommand('S', this->pin * 1000L + angle); }
+private:
+    int pin = -1;
+};
+
+// <Adafruit_SSD1306.h> (128x32):
+#define SSD1306_LCDHEIGHT 32
+#define SSD1306_SWITCHCAPVCC 2
+#define BLACK 0
+#define WHITE 1
+class Adafruit_SSD1306{
+public:
+    Adafruit_SSD1306(int){ }
+    void begin(int, int){ }
+    int width() const{ return 128; }
+    int height() const{ return SSD1306_LCDHEIGHT; }
+    void invertDisplay(bool i){ hostCommand('I', i); }
+    void clearDisplay(){ }
+    void drawRect(int, int, int, int, int){ }
+    void drawLine(int, int, int, int, int){ this->lines++; }
+    void display(){
+        hostCommand('D', this->lines);
+        this->lines = 0;
+    }
+private:
+    long lines = 0; // Lines Drawn since the Last Frame
+};
+
+// <Encoder.h>:
+class Encoder{
+public:
+    long (*reading)() = nullptr; // Supplies Each Count Read
+    Encoder(int, int){ }
+    long read(){ return this->reading ? this->reading() : 0; }
+};
+
+// <AccelStepper.h> (jumps straight to its target):
+class AccelStepper{
+public:
+    AccelStepper(int, int, int){ }
+    void setMaxSpeed(float){ }
+    void setAcceleration(float){ }
+    void stop(){ }
+    void moveTo(long t){
+        this->target = t;
+        hostCommand('M', t);
+    }
+    void move(long d){ this->moveTo(this->position + d); }
+    long distanceToGo() const{ return this->target - this->position; }
+    long targetPosition() const{ return this->target; }
+    bool run(){
+        this->position = this->target;
+        return false;
+    }
+private:
+    long position = 0, target = 0;
+};
+#endif // HOST_STUBS_H
+#endif
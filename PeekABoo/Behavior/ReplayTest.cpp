@@ -0,0 +1,203 @@
+#ifdef _CFCT_ // Compiling for g++ Testing (keeps avr-gcc from bugging about this file)
+/* Host Test of Recording Sensor Reads with a SensorLog and Replaying them.
+ * Runs the sketch itself (Behavior.ino and HAL.h, built with RECORD_SENSORS
+ * on the stand-ins in HostStubs.h) through a randomized session of people
+ * coming and going (and touching the robot), then replays the log it wrote
+ * to Serial through the sketch again and checks that it commands its servos
+ * and display exactly the same way, at the same times, every time.
+ * Given the path of a log captured from a robot built with RECORD_SENSORS,
+ * it replays that instead and prints what the robot did.
+ * Build: g++ -std=gnu++11 -D_CFCT_ -O2 -o replay ReplayTest.cpp
+ * Usage: ./replay [log.bin]
+ */
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <sys/wait.h>
+#define SCHEDULE_VIRTUAL_CLOCK
+#define RECORD_SENSORS
+#include "Schedule.h"
+unsigned long millis(){ return VirtualClock::now(); }
+#include "HostStubs.h"
+#include "Behavior.ino"
+
+#define pl(x) std::cout << x << std::endl
+
+#define SESSION 600000UL // Length of the Recorded Session [ms]
+
+/* Something the Robot Did (and When): a command to one of its servos or its
+ display (see HostStubs.h). */
+struct Happening{
+    unsigned long time;
+    char device;
+    long value;
+    bool operator==(const Happening& other) const{
+        return this->time == other.time && this->device == other.device && this->value == other.value;
+    }
+};
+std::vector<Happening> trace;
+void traceCommand(char device, long value){ trace.push_back(Happening{millis(), device, value}); }
+
+// Mocked World:
+uint32_t seed = 12345;
+long randomIn(long lo, long hi){
+    seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+    return lo + (long)(seed % (uint32_t)(hi - lo));
+}
+bool visiting(){ return (millis() / 20000) % 3 == 1; } // Someone Stops by for 20s every Minute
+bool touching(){ return visiting() && (millis() / 1000) % 7 == 3; }
+float worldDist(){ return (float)(visiting() ? randomIn(10, 30) : randomIn(60, 120)) + randomIn(0, 100) / 100.0f; }
+long worldCap(){ return touching() ? randomIn(25, 60) : randomIn(0, 24); }
+
+// Replayed World:
+SensorReplay* replay;
+float replayDist(){ return replay->readFloat(CH_DIST); }
+long replayCap(){ return replay->readInteger(CH_CAP); }
+
+/* What Came of Running the Sketch Once. */
+struct Session{
+    std::vector<Happening> trace;
+    std::vector<uint8_t> log; // Everything the Sketch Wrote to Serial
+    unsigned long dropped = 0; // Reads the Sketch's SensorLog Dropped
+    bool finished = true; // Whether the Log Replayed (if any) was Played to the End
+    double ms = 0; // Time Taken [ms]
+};
+
+// Writes/Reads %n% Bytes through a Pipe:
+void put(int fd, const void* data, size_t n){
+    const char* p = (const char*) data;
+    while(n > 0){
+        ssize_t w = write(fd, p, n);
+        if(w <= 0){ _exit(1); }
+        p += w;
+        n -= w;
+    }
+} // #put
+bool get(int fd, void* data, size_t n){
+    char* p = (char*) data;
+    while(n > 0){
+        ssize_t r = read(fd, p, n);
+        if(r <= 0){ return false; }
+        p += r;
+        n -= r;
+    }
+    return true;
+} // #get
+
+/* Sets up the Sketch and Runs it for %duration% ms (or, if 0, a minute at a
+ time until the %log% is finished) on the Mocked World or, if %log% is given,
+ Replaying it. */
+Session perform(unsigned long duration, const std::vector<uint8_t>* log){
+    VirtualClock::set(0);
+    SensorReplay* r = nullptr;
+    if(log){
+        r = new SensorReplay(log->data(), log->size());
+        replay = r;
+        UltraSonicDistanceSensor::reading = replayDist;
+        CapacitiveSensor::reading = replayCap;
+    } else{
+        UltraSonicDistanceSensor::reading = worldDist;
+        CapacitiveSensor::reading = worldCap;
+    }
+    host_command = traceCommand;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    setup();
+    if(duration){
+        sch->simulate(duration, 10);
+    } else{
+        while(!r->finished()){
+            sch->simulate(60000, 10);
+        }
+    }
+    sensor_log.flush(Serial);
+    Session s;
+    s.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    s.trace = trace;
+    s.log = Serial.bytes;
+    s.dropped = sensor_log.dropped;
+    s.finished = !r || r->finished();
+    delete r;
+    delete sch;
+    return s;
+} // #perform
+
+/* Runs the Sketch (see #perform) in a Child Process, since its schedule and
+ the statics in its HAL only start out fresh once per process. */
+Session run(unsigned long duration, const std::vector<uint8_t>* log){
+    Session s;
+    int fds[2];
+    if(pipe(fds) != 0){ return s; }
+    std::cout.flush();
+    pid_t child = fork();
+    if(child == 0){
+        close(fds[0]);
+        Session done = perform(duration, log);
+        size_t sizes[2] = {done.trace.size(), done.log.size()};
+        put(fds[1], sizes, sizeof(sizes));
+        put(fds[1], done.trace.data(), sizes[0] * sizeof(Happening));
+        put(fds[1], done.log.data(), sizes[1]);
+        put(fds[1], &done.dropped, sizeof(done.dropped));
+        put(fds[1], &done.finished, sizeof(done.finished));
+        put(fds[1], &done.ms, sizeof(done.ms));
+        close(fds[1]);
+        _exit(0);
+    }
+    close(fds[1]);
+    size_t sizes[2];
+    if(get(fds[0], sizes, sizeof(sizes))){
+        s.trace.resize(sizes[0]);
+        s.log.resize(sizes[1]);
+        get(fds[0], s.trace.data(), sizes[0] * sizeof(Happening));
+        get(fds[0], s.log.data(), sizes[1]);
+        get(fds[0], &s.dropped, sizeof(s.dropped));
+        get(fds[0], &s.finished, sizeof(s.finished));
+        get(fds[0], &s.ms, sizeof(s.ms));
+    } else{
+        s.finished = false; // The Sketch Never Finished
+    }
+    close(fds[0]);
+    waitpid(child, nullptr, 0);
+    return s;
+} // #run
+
+int main(int argc, char** argv){
+    if(argc > 1){
+        std::ifstream file(argv[1], std::ios::binary);
+        std::vector<uint8_t> log((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        Session replayed = run(0, &log);
+        for(std::vector<Happening>::size_type i = 0; i != replayed.trace.size(); i++){
+            pl(replayed.trace[i].time << ',' << replayed.trace[i].device << ',' << replayed.trace[i].value);
+        }
+        pl("# " << log.size() << " bytes, " << replayed.ms / 1000 << "s to replay");
+        return replayed.finished ? 0 : 1;
+    }
+
+    int failures = 0;
+    // Record:
+    Session recorded = run(SESSION, nullptr);
+    unsigned long servo_moves = 0, frames = 0;
+    for(std::vector<Happening>::size_type i = 0; i != recorded.trace.size(); i++){
+        servo_moves += recorded.trace[i].device == 'S';
+        frames += recorded.trace[i].device == 'D';
+    }
+    pl("recorded " << SESSION / 1000 << "s: " << servo_moves << " servo moves, " << frames << " frames, "
+        << recorded.log.size() << " bytes of log, " << recorded.dropped << " reads dropped");
+    if(recorded.dropped || !servo_moves || !frames){ failures++; }
+
+    // Replay (twice):
+    for(int n = 0; n < 2; n++){
+        Session replayed = run(SESSION, &recorded.log);
+        bool same = replayed.trace == recorded.trace;
+        pl("replay " << n + 1 << ": " << replayed.trace.size() << " commands, " << (same ? "identical" : "DIFFERENT")
+            << ", " << SESSION / replayed.ms << "x real time");
+        if(!same || !replayed.finished){ failures++; }
+    }
+
+    pl((failures ? "FAILED" : "PASSED"));
+    return failures ? 1 : 0;
+}
+#endif
@@ -0,0 +1,384 @@
+#ifdef _CFCT_ // Compiling for g++ Testing (keeps avr-gcc from bugging about this file)
+/* Host Benchmarks for Schedule.h
+ * Build: g++ -D_CFCT_ -O2 -o bench ScheduleBench.cpp
+ * Every table is printed as CSV (preceded by its header line) so results can
+ * be diffed / tracked across releases.
+ */
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <new>
+#include <cstring>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+static unsigned long bench_now = 0; // Simulated Time [ms]
+unsigned long millis(){ return bench_now; }
+#include "Schedule.h"
+
+#define pl(x) std::cout << x << std::endl
+
+// Number of Calls Made in each Benchmark:
+#define N_CALLS 50000000UL
+// Number of Passes Made in each Schedule Benchmark:
+#define N_PASSES 2000000UL
+// Number of Passes Timed for each Budget in #benchPassBudget:
+#define N_BUDGET_PASSES 2000UL
+
+volatile unsigned long sink = 0; // Keeps the Compiler from Optimizing Calls Away
+
+// Heap Accounting (every allocation in the program goes through these):
+static unsigned long n_allocs = 0; // Number of Allocations Made
+static size_t heap_live = 0; // Bytes Currently Allocated
+static size_t heap_peak = 0; // Most Bytes Allocated at Once
+static const size_t HEAP_HEADER = 16; // Room Kept before each Block for its Size (keeps alignment)
+
+__attribute__((noinline)) void* operator new(size_t n){
+    unsigned char* p = (unsigned char*) malloc(n + HEAP_HEADER);
+    if(!p){ throw std::bad_alloc(); }
+    *(size_t*)p = n;
+    n_allocs++;
+    heap_live += n;
+    if(heap_live > heap_peak){ heap_peak = heap_live; }
+    return p + HEAP_HEADER;
+}
+__attribute__((noinline)) void operator delete(void* p) noexcept{
+    if(!p){ return; }
+    unsigned char* b = (unsigned char*)p - HEAP_HEADER;
+    heap_live -= *(size_t*)b;
+    free(b);
+}
+void* operator new[](size_t n){ return operator new(n); }
+void operator delete[](void* p) noexcept{ operator delete(p); }
+void operator delete(void* p, size_t) noexcept{ operator delete(p); }
+void operator delete[](void* p, size_t) noexcept{ operator delete(p); }
+
+void count(){ sink++; }
+bool everyThird(){ return sink % 3 == 0; }
+bool everyOther(){ return sink & 1; }
+bool onThirdMs(){ return bench_now % 3 == 0; }
+bool onOddMs(){ return bench_now & 1; }
+bool onOddTenth(){ return (bench_now / 100) & 1; }
+
+// Returns the CPU's Timestamp Counter (cycles) where Available:
+static inline unsigned long long cycles(){
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+} // #cycles
+
+// Hardware Event Counter (branch misses, cache misses, etc.) for this Process,
+// where the kernel allows it (reads -1 otherwise):
+class PerfCounter{
+public:
+    PerfCounter(unsigned long long config){
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        this->fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    } // ctor
+
+    ~PerfCounter(){
+        if(this->fd >= 0){ close(this->fd); }
+    } // dtor
+
+    long long read(){
+        long long count = -1;
+        if(this->fd < 0 || ::read(this->fd, &count, sizeof(count)) != sizeof(count)){
+            return -1;
+        }
+        return count;
+    } // #read
+
+private:
+    int fd;
+}; // class PerfCounter
+
+// Returns the Average Time [ns] of each Call to %f% over N_CALLS Calls:
+template <typename F>
+double timeCalls(F& f){
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(unsigned long i = 0; i < N_CALLS; i++){
+        f();
+    }
+    std::chrono::duration<double, std::nano> dt = std::chrono::steady_clock::now() - start;
+    return dt.count() / N_CALLS;
+} // #timeCalls
+
+/* Compares Calling a Plain Function Pointer (the old RegisteredFunction) with
+ Calling an InlineFunction Holding the Same Function or a Capturing Lambda. */
+void benchCallables(){
+    void (* volatile fptr)() = count; // volatile so the call stays indirect
+    InlineFunction<void()> wrapped = count;
+    unsigned long local = 0;
+    InlineFunction<void()> capturing = [&local](){ local++; sink++; };
+    BasicAction action(count);
+
+    pl("callable,ns_per_call");
+    pl("function_pointer," << timeCalls(fptr));
+    pl("inline_function," << timeCalls(wrapped));
+    pl("inline_function_capturing," << timeCalls(capturing));
+    struct { BasicAction* a; void operator()(){ a->call(); } } through_action = {&action};
+    pl("basic_action," << timeCalls(through_action));
+} // #benchCallables
+
+// Prints the ns and Cycles per Pass of Running %sch%'s #loop with 1ms Passing per Pass:
+template <typename S>
+void timePasses(const char* name, S& sch){
+    bench_now = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    unsigned long long c0 = cycles();
+    for(unsigned long i = 0; i < N_PASSES; i++){
+        bench_now++;
+        sch.loop();
+    }
+    unsigned long long c1 = cycles();
+    std::chrono::duration<double, std::nano> dt = std::chrono::steady_clock::now() - start;
+    pl(name << "," << dt.count() / N_PASSES << "," << (double)(c1 - c0) / N_PASSES);
+} // #timePasses
+
+/* Compares a Dynamic Schedule with a StaticSchedule Running the Same Events. */
+void benchStaticSchedule(){
+    bench_now = 0;
+    Schedule dynamic;
+    dynamic.every(10)->do_(count);
+    dynamic.every(50)->do_(count);
+    dynamic.when(everyThird)->do_(count);
+    dynamic.while_(everyOther)->do_(count);
+    dynamic.everyWhile(100, everyOther)->do_(count);
+
+    StaticSchedule<
+        Every<10, count>,
+        Every<50, count>,
+        When<everyThird, count>,
+        While<everyOther, count>,
+        EveryWhile<100, everyOther, count>
+    > fixed;
+
+    pl("schedule,ns_per_pass,cycles_per_pass");
+    timePasses("dynamic", dynamic);
+    timePasses("static", fixed);
+} // #benchStaticSchedule
+
+// Prints Time, Cycles, Branch Misses and Cache Misses per Call of %pass%
+// over %passes% Calls (misses are -1 where counters aren't available):
+template <typename F>
+void timeLayout(const char* name, unsigned long n, unsigned long passes, F pass){
+    PerfCounter branch_misses(PERF_COUNT_HW_BRANCH_MISSES);
+    PerfCounter cache_misses(PERF_COUNT_HW_CACHE_MISSES);
+    bench_now = 0;
+    long long b0 = branch_misses.read();
+    long long m0 = cache_misses.read();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    unsigned long long c0 = cycles();
+    for(unsigned long i = 0; i < passes; i++){
+        bench_now++;
+        pass();
+    }
+    unsigned long long c1 = cycles();
+    std::chrono::duration<double, std::nano> dt = std::chrono::steady_clock::now() - start;
+    long long b1 = branch_misses.read();
+    long long m1 = cache_misses.read();
+    pl(name << "," << n << "," << dt.count() / passes << "," << (double)(c1 - c0) / passes
+        << "," << (b0 < 0 ? -1.0 : (double)(b1 - b0) / passes)
+        << "," << (m0 < 0 ? -1.0 : (double)(m1 - m0) / passes));
+} // #timeLayout
+
+bool onThirdMs();
+bool onOddMs();
+bool onOddTenth();
+
+/* Compares the Schedule's Polled Events (kept in one bucket per type, checked
+ without virtual calls and with their functions stored in place) against the
+ layout they used to have: one list of every type mixed together, polled
+ through the vtable, each function in its own heap-allocated Action. */
+void benchLayout(){
+    static const unsigned long sizes[] = {10, 100, 1000, 10000};
+    pl("layout,n_events,ns_per_pass,cycles_per_pass,branch_misses_per_pass,cache_misses_per_pass");
+    for(unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++){
+        unsigned long n = sizes[s];
+        unsigned long passes = N_PASSES / n < 200 ? 200 : N_PASSES / n;
+        Schedule* bucketed = new Schedule();
+        Schedule* owner = new Schedule(); // Owns the Mixed Events (but is never looped)
+        std::vector<Event*> mixed;
+        for(unsigned long i = 0; i < n; i++){
+            schedule_time_t t = 1 + i % 10;
+            switch(i % 3){
+                case 0:
+                    bucketed->while_(onOddMs)->do_(count);
+                    mixed.push_back(owner->while_(onOddMs));
+                    break;
+                case 1:
+                    bucketed->when(onThirdMs)->do_(count);
+                    mixed.push_back(owner->when(onThirdMs));
+                    break;
+                default:
+                    bucketed->everyWhile(t, onOddTenth)->do_(count);
+                    mixed.push_back(owner->everyWhile(t, onOddTenth));
+                    break;
+            }
+            mixed.back()->do_(new BasicAction(count));
+        }
+        timeLayout("bucketed", n, passes, [bucketed](){ bucketed->loop(); });
+        timeLayout("mixed_virtual", n, passes, [&mixed](){
+            for(std::vector<Event*>::size_type i = 0; i != mixed.size(); i++){
+                mixed[i]->tryExecute();
+            }
+        });
+        for(std::vector<Event*>::size_type i = 0; i != mixed.size(); i++){
+            delete mixed[i]; // Gives their Actions' States back to the Pool (%owner% never touches them)
+        }
+    }
+} // #benchLayout
+
+// Schedule being Swept (lets captureless actions re-arm their events):
+static Schedule* swept = nullptr;
+
+void rearm(){ sink++; swept->in_(10)->do_(rearm); } // Keeps one one-shot pending
+void nest(Action* a){ a->done.follow(swept->in_(5)->do_(count)); } // What DO_LONG makes
+
+// Types of Event Swept by #benchSweep:
+enum SweptType{ SWEEP_EVERY, SWEEP_IN, SWEEP_WHEN, SWEEP_WHILE, SWEEP_EVERY_WHILE, SWEEP_DO_LONG, N_SWEPT_TYPES };
+static const char* swept_names[N_SWEPT_TYPES] = {"every", "in_", "when", "while_", "everyWhile", "DO_LONG"};
+
+// Adds Event %i% of the Given Type to %swept% (timed ones get intervals of 1-10ms):
+void addSwept(SweptType type, unsigned long i){
+    schedule_time_t t = 1 + i % 10;
+    switch(type){
+        case SWEEP_EVERY: swept->every(t)->do_(count); break;
+        case SWEEP_IN: swept->in_(t)->do_(rearm); break;
+        case SWEEP_WHEN: swept->when(onThirdMs)->do_(count); break;
+        case SWEEP_WHILE: swept->while_(onOddMs)->do_(count); break;
+        case SWEEP_EVERY_WHILE: swept->everyWhile(t, onOddTenth)->do_(count); break;
+        case SWEEP_DO_LONG: swept->every(t)->do_(new NestingAction(nest)); break;
+        default: break;
+    }
+} // #addSwept
+
+/* Prints one Row of #benchSweep for %n% Events of the Given Type. */
+void sweepOnce(SweptType type, unsigned long n){
+    unsigned long passes = N_PASSES / n < 200 ? 200 : N_PASSES / n;
+    bench_now = 0;
+    size_t heap_base = heap_live;
+    heap_peak = heap_live;
+    unsigned int overflows_base = ActionState::overflows();
+
+    swept = new Schedule();
+    for(unsigned long i = 0; i < n; i++){
+        addSwept(type, i);
+    }
+    for(unsigned long i = 0; i < 10; i++){ // Warm Up (reach the steady state)
+        bench_now++;
+        swept->loop();
+    }
+
+    unsigned long allocs_base = n_allocs;
+    unsigned long dispatched_base = sink;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(unsigned long i = 0; i < passes; i++){
+        bench_now++;
+        swept->loop();
+    }
+    std::chrono::duration<double, std::nano> dt = std::chrono::steady_clock::now() - start;
+    unsigned long dispatched = sink - dispatched_base;
+
+    pl(swept_names[type] << "," << n << "," << passes
+        << "," << dt.count() / passes
+        << "," << (dispatched ? dt.count() / dispatched : 0)
+        << "," << (n_allocs - allocs_base) / (dt.count() / 1e9)
+        << "," << heap_peak - heap_base
+        << "," << ActionState::overflows() - overflows_base);
+} // #sweepOnce
+
+/* Measures the Cost of #loop as the Number of Events of each Type Grows
+ (1..10,000): time per pass, time per action dispatched, allocations per second
+ in steady state, the peak heap used by the schedule (from construction) and
+ how many Actions found the ActionState pool empty. Each row runs in its own
+ process, so it starts from a fresh heap and ActionState pool (which every
+ Schedule shares, and which outlives them). */
+void benchSweep(){
+    static const unsigned long sizes[] = {1, 10, 100, 1000, 10000};
+    pl("event_type,n_events,passes,ns_per_pass,ns_per_dispatch,allocs_per_sec,peak_heap_bytes,state_overflows");
+    for(int type = 0; type < N_SWEPT_TYPES; type++){
+        for(unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++){
+            std::cout.flush();
+            pid_t child = fork();
+            if(child == 0){
+                sweepOnce((SweptType) type, sizes[s]);
+                std::cout.flush();
+                _exit(0);
+            }
+            waitpid(child, nullptr, 0);
+        }
+    }
+} // #benchSweep
+
+// Busy-Waits for %us% Microseconds (stands in for a heavy behavior):
+void spinFor(unsigned long us){
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::microseconds(us);
+    while(std::chrono::steady_clock::now() < end){ sink++; }
+} // #spinFor
+
+// Pass on which each Light Event Last Ran, and the Longest it's Waited [passes]:
+static unsigned long light_last[16];
+static unsigned long light_wait = 0;
+
+/* Measures the Distribution of Pass Times with and without a Budget (see
+ Schedule#loop) on a Schedule where 8 heavy behaviors (1ms each) all fire
+ together every 50ms on top of 16 light events which want every pass, and how
+ long the light events are kept waiting by the bursts (the most passes between
+ two of their runs). */
+void benchPassBudget(){
+    static const unsigned long budgets[] = {0, 4000, 2000, 1000};
+    pl("budget_us,passes,p50_us,p90_us,p99_us,max_us,overruns,worst_overrun_us,max_light_wait_passes");
+    for(unsigned int b = 0; b < sizeof(budgets) / sizeof(budgets[0]); b++){
+        bench_now = 0;
+        Schedule* sch = new Schedule();
+        for(int i = 0; i < 8; i++){
+            sch->every(50)->do_([](){ spinFor(1000); });
+        }
+        light_wait = 0;
+        for(int i = 0; i < 16; i++){
+            light_last[i] = 0;
+            sch->every(1)->do_([i, sch](){
+                if(sch->passes - light_last[i] > light_wait){ light_wait = sch->passes - light_last[i]; }
+                light_last[i] = sch->passes;
+                spinFor(5);
+            });
+        }
+        std::vector<double> pass_us;
+        for(unsigned long i = 0; i < N_BUDGET_PASSES; i++){
+            bench_now++;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            sch->loop(budgets[b]);
+            pass_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+        std::sort(pass_us.begin(), pass_us.end());
+        pl(budgets[b] << "," << N_BUDGET_PASSES
+            << "," << pass_us[pass_us.size() / 2]
+            << "," << pass_us[pass_us.size() * 9 / 10]
+            << "," << pass_us[pass_us.size() * 99 / 100]
+            << "," << pass_us.back()
+            << "," << sch->budget_overruns
+            << "," << sch->worst_overrun
+            << "," << light_wait);
+    }
+} // #benchPassBudget
+
+int main(){
+    benchCallables();
+    benchStaticSchedule();
+    benchLayout();
+    benchSweep();
+    benchPassBudget();
+    return 0;
+}
+#endif
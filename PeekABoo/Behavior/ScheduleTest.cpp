@@ -1,15 +1,17 @@
 #ifdef _CFCT_ // Compiling for g++ Testing (keeps avr-gcc from bugging about this file)
 #include <iostream>
 #include <time.h>
-unsigned long millis(){ return 1000 * clock() / CLOCKS_PER_SEC; }
+// Run on Virtual Time, so the Test is Instant and its Output Never Changes:
+#define SCHEDULE_VIRTUAL_CLOCK
 #include "Schedule.h"
+unsigned long millis(){ return VirtualClock::now(); }
 
 Schedule* sch = new Schedule();
 
 #define pl(x) std::cout << x << std::endl
 #define plt(x) std::cout << x << " - " << millis() << std::endl
 
-bool** beepboopd = new bool*(new bool(false));
+ActionState beepboopd;
 
 // Test:
 int main()
@@ -26,11 +28,16 @@ int main()
 
     //sch->EVERY_WHILE(2, millis() >= 1105 && millis() <= 1142 || millis() >= 2100 && millis() <= 2200)->DO( plt("CLIP"); );
 
-    beepboopd = sch->IN(3100)->DO_LONG( *(sch->IN(1000)->DO( plt("***BEEP***BOOP***"); )); );
-    sch->WHEN(**beepboopd)->DO( plt("## BOP ##"); );
-
-    while(1){
-        sch->loop();
-    }
+    beepboopd = sch->IN(3100)->DO_LONG( sch->IN(1000)->DO( plt("***BEEP***BOOP***"); ) );
+    beepboopd.then([](){ plt("## BOP ##"); });
+
+    // Fast-Forward an Hour (jumping straight from each event to the next):
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    unsigned long passes = sch->simulate(3600000UL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    std::cout << "Simulated 1h in " << passes << " passes, "
+              << (1000.0 * (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e6)
+              << "ms" << std::endl;
 }
 #endif
@@ -0,0 +1,229 @@
+#ifdef _CFCT_ // Compiling for g++ Testing (keeps avr-gcc from bugging about this file)
+/* Host Test of how long ActionStates (and what holds them) Live. Churns
+ * through far more states than the pool has slots and checks that handles
+ * kept from long before still read as they should, that cancelling events
+ * gives back the states of actions which never ran, that functions signed
+ * up only take states when they're asked for, that cancelled events are
+ * freed, that joining on states which are already done goes on right away,
+ * that continuations which can't be waited for give their slots back, that
+ * deleting a Schedule frees everything it made, and that the pool never runs
+ * dry.
+ * Build: g++ -std=gnu++11 -D_CFCT_ -o states StateTest.cpp
+ */
+#include <iostream>
+static unsigned long sim_now = 0; // Simulated Time [ms]
+unsigned long millis(){ return sim_now; }
+#include "Schedule.h"
+
+#define pl(x) std::cout << x << std::endl
+
+int failures = 0;
+#define CHECK(name, got, expected) \
+if((got) != (expected)){ pl("FAIL: " << name << " = " << (got) << ", expected " << (expected)); failures++; } \
+else{ pl("ok: " << name << " = " << (got)); }
+
+unsigned long runs = 0;
+Schedule* sch;
+
+// Counts the Copies of it which are Alive (so each function capturing one):
+struct Tracked{
+    static long live;
+    Tracked(){ live++; }
+    Tracked(const Tracked&){ live++; }
+    ~Tracked(){ live--; }
+};
+long Tracked::live = 0;
+State<int> level(0);
+
+// Returns how many States can be Taken from the Pool at Once:
+unsigned int freeStates(){
+    std::vector<ActionState> taken;
+    for(int i = 0; i < SCHEDULE_ACTION_STATES; i++){
+        ActionState s = ActionState::make(false);
+        if(s.index == ActionState::NONE){ break; }
+        taken.push_back(s);
+    }
+    for(std::vector<ActionState>::size_type i = 0; i != taken.size(); i++){
+        taken[i].abandon();
+    }
+    return taken.size();
+} // #freeStates
+
+int main(){
+    sch = new Schedule();
+
+    // Stale Handles: a done state kept while its slot is reused 256 times
+    // (which used to wrap its generation around) must still read as done.
+    ActionState old = sch->NOW->do_([](){ runs++; });
+    sch->loop();
+    CHECK("old state done", old.get(), true);
+    for(int i = 0; i < 255; i++){ // The 256th Reuse of its Slot
+        sim_now++;
+        ActionState churn = sch->NOW->do_([](){ runs++; });
+        sch->loop();
+        if(!churn.get()){ failures++; }
+    }
+    ActionState fresh = ActionState::make(false);
+    CHECK("old state still done", old.get(), true);
+    CHECK("fresh state not done", fresh.get(), false);
+    fresh.release();
+    CHECK("runs", runs, 256ul);
+    CHECK("pool overflows", ActionState::overflows(), 0u);
+
+    // Abandoned States: cancelling events whose actions never ran gives back
+    // their slots (many more than the pool has), and what waits on them runs.
+    static unsigned long chained = 0;
+    for(int round = 0; round < 20; round++){
+        std::vector<Event*> events;
+        std::vector<ActionState> states;
+        for(int i = 0; i < 10; i++){
+            Event* e = sch->every(1000);
+            states.push_back(e->do_([](){ runs++; }));
+            states.push_back(e->DO_LONG(sch->IN(5000)->DO(runs++)));
+            events.push_back(e);
+        }
+        states[0].then([](){ chained++; });
+        for(int i = 0; i < 10; i++){
+            events[i]->pause();
+            events[i]->cancel();
+        }
+        for(int i = 0; i < 1001; i++){ // Till the Schedule Comes Across them
+            sim_now++;
+            sch->loop();
+        }
+        bool all_done = true;
+        for(std::vector<ActionState>::size_type i = 0; i != states.size(); i++){
+            all_done = all_done && states[i].get();
+        }
+        if(!all_done){ failures++; }
+    }
+    CHECK("states of cancelled actions done", failures, 0);
+    CHECK("chained on cancelled", chained, 20ul);
+    CHECK("pool overflows after cancelling", ActionState::overflows(), 0u);
+    ActionState after = ActionState::make(false);
+    CHECK("new state after cancelling", after.get(), false);
+    after.release();
+
+    // Unused States: signing up far more functions than the pool has slots
+    // takes none of them unless their done states are asked for.
+    static unsigned long both = 0;
+    for(int i = 0; i < 100; i++){
+        sch->every(10)->do_([](){ runs++; });
+    }
+    ActionState first = sch->in_(3)->do_([](){ runs++; });
+    when_all(first, sch->in_(5)->do_([](){ runs++; })).then([](){ both++; });
+    CHECK("first not done yet", first.get(), false);
+    for(int i = 0; i < 20; i++){
+        sim_now++;
+        sch->loop();
+    }
+    CHECK("first done", first.get(), true);
+    CHECK("when_all of do_s", both, 1ul);
+    CHECK("pool overflows with unused states", ActionState::overflows(), 0u);
+
+    // Cancelled Reactive and Unlisted Events: freed (with their functions)
+    // though no list of the schedule's comes across them.
+    Tracked tracked;
+    static unsigned long reactions = 0, triggered = 0;
+    std::vector<Event*> reactives;
+    for(int i = 0; i < 10; i++){
+        ConditionalEvent* w = sch->when([](){ return level.get() > 5; })->reactive();
+        w->do_([tracked](){ reactions++; });
+        reactives.push_back(w);
+    }
+    Event* pinged = sch->onTrigger();
+    pinged->do_([tracked](){ triggered++; });
+    sch->loop(); // Reactive Events Subscribe to %level%
+    CHECK("live functions", Tracked::live, 12l);
+    sch->trigger(pinged);
+    for(int i = 0; i < 10; i++){
+        reactives[i]->cancel();
+    }
+    pinged->cancel(); // Before its Trigger Runs
+    CHECK("unlisted event freed on cancel", Tracked::live, 11l);
+    sch->loop();
+    CHECK("reactive events freed", Tracked::live, 1l);
+    CHECK("level unwatched", level.watched(), false);
+    level.set(10);
+    sch->loop();
+    CHECK("cancelled events ran", reactions + triggered, 0ul);
+
+    // Joining Done States: the state of a resumable whose task has finished
+    // (its Action still holds the slot) is done, so whatever joins on it
+    // goes on right away.
+    ActionState resumed = sch->every(1000)->resumable([](Task* task){ TASK_BEGIN; TASK_END; });
+    for(int i = 0; i < 1001; i++){
+        sim_now++;
+        sch->loop();
+    }
+    CHECK("resumable done", resumed.get(), true);
+    static unsigned long any_ran = 0, then_ran = 0;
+    ActionState pending = ActionState::make(false);
+    ActionState all = when_all(resumed, pending);
+    when_any(resumed, pending).then([](){ any_ran++; });
+    resumed.then([](){ then_ran++; });
+    CHECK("when_any of a done state", any_ran, 1ul);
+    CHECK("then of a done state", then_ran, 1ul);
+    CHECK("when_all waits on the rest", all.get(), false);
+    pending.set(true);
+    CHECK("when_all of a done state", all.get(), true);
+    pending.release();
+
+    // Failed Waits: continuations which can't be waited for (on null states,
+    // or with every continuation slot taken) give back the slots taken for
+    // their results.
+    unsigned int free_before = freeStates();
+    unsigned int continuation_overflows = ActionState::continuationOverflows();
+    ActionState blocker = ActionState::make(false);
+    for(int i = 0; i < SCHEDULE_CONTINUATIONS + 4; i++){
+        blocker.then([](){ runs++; });
+    }
+    CHECK("continuation overflows", ActionState::continuationOverflows() - continuation_overflows, 4u);
+    blocker.set(true);
+    blocker.release();
+    for(int i = 0; i < 40; i++){
+        ActionState().then([](){ runs++; });
+        when_all(ActionState(), ActionState::finished());
+        when_any(ActionState(), ActionState());
+    }
+    CHECK("when_all of a null state", (int) when_all(ActionState(), ActionState::finished()).index, (int) ActionState::NONE);
+    CHECK("free states after failed waits", freeStates(), free_before);
+
+    // Deleting a Schedule: every kind of event it made (parked, unlisted,
+    // reactive, in the ready queue, pooled or not), its tasks and its signals
+    // are freed, and what waits on their unfinished actions runs.
+    long live_before = Tracked::live;
+    static unsigned long torn_down = 0;
+    static Schedule* doomed; // (static, so DO_LONG can use it)
+    doomed = new Schedule();
+    doomed->every(10)->do_([tracked](){ runs++; });
+    doomed->while_([tracked](){ return true; })->do_([](){ runs++; });
+    doomed->when([tracked](){ return level.get() > 100; })->reactive()->do_([](){ runs++; });
+    Signal<int>* sampled = doomed->sample([tracked](){ return 1; });
+    doomed->when([sampled](){ return sampled->read() > 1; })->reactive()->do_([](){ runs++; });
+    Event* parked_event = doomed->when([tracked](){ return false; });
+    parked_event->pause();
+    doomed->onTrigger()->do_([tracked](){ runs++; });
+    doomed->everyWhile(5, [tracked](){ return true; })->critical()->do_([](){ runs++; });
+    for(int i = 0; i < SCHEDULE_ONESHOT_SLOTS + 4; i++){ // Pooled and Allocated
+        doomed->in_(1000)->do_([tracked](){ runs++; });
+    }
+    doomed->NOW->do_([tracked](){ runs++; });
+    doomed->spawn([tracked](Task* task){ TASK_BEGIN; WAIT(1000); TASK_END; }).then([](){ torn_down++; });
+    doomed->every(1000)->DO_LONG(doomed->IN(5000)->DO(runs++)).then([](){ torn_down++; });
+    for(int i = 0; i < 20; i++){
+        sim_now++;
+        doomed->loop(); // Parks the Paused WHEN, Subscribes the Reactive ones
+    }
+    doomed->NOW->do_([tracked](){ runs++; }); // Left in the Ready Queue
+    CHECK("level watched by the schedule", level.watched(), true);
+    delete doomed;
+    CHECK("functions freed with the schedule", Tracked::live, live_before);
+    CHECK("level unwatched after deleting", level.watched(), false);
+    CHECK("unfinished actions done", torn_down, 2ul);
+    CHECK("free states after deleting", freeStates(), free_before);
+
+    pl((failures ? "FAILED" : "PASSED"));
+    return failures ? 1 : 0;
+}
+#endif
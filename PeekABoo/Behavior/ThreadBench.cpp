@@ -0,0 +1,73 @@
+#ifdef _CFCT_ // Compiling for g++ Testing (keeps avr-gcc from bugging about this file)
+/* Host Benchmark of Independent Events on Worker Threads (SCHEDULE_THREADS).
+ * Runs a pass full of heavy independent actions with 0 (inline), 1, 2, ...
+ * threads and checks that every action ran once per pass and was done by the
+ * end of its pass (and that what an action keeps in its own captures lasts
+ * from one pass to the next).
+ * Build: g++ -std=gnu++11 -D_CFCT_ -O2 -pthread -o threads ThreadBench.cpp
+ */
+#include <iostream>
+#include <chrono>
+#include <thread>
+static unsigned long bench_now = 0; // Simulated Time [ms]
+unsigned long millis(){ return bench_now; }
+#define SCHEDULE_THREADS
+#define SCHEDULE_ACTION_STATES 200 // Room for the Done States of every Run
+#include "Schedule.h"
+
+#define pl(x) std::cout << x << std::endl
+
+#define N_EVENTS 32 // Independent Events, all Every(1)
+#define N_PASSES 200
+#define WORK 20000 // Iterations of Busy Work per Action (~0.1ms)
+
+double results[N_EVENTS]; // Each Action only Touches its own Entry
+unsigned long runs[N_EVENTS];
+
+/* Stand-in for Logging / Model Evaluation. */
+double work(double x){
+    for(int i = 0; i < WORK; i++){
+        x = x * 1.0000001 + 0.5 / (1.0 + x);
+    }
+    return x;
+}
+
+int main(){
+    unsigned int cores = std::thread::hardware_concurrency();
+    pl("threads,passes,ms,speedup");
+    double base_ms = 0;
+    int failures = 0;
+    for(unsigned int n = 0; n <= (cores > 1 ? cores : 2); n = n ? 2 * n : 1){
+        Schedule* sch = new Schedule();
+        sch->useThreads(n);
+        ActionState dones[N_EVENTS];
+        for(int i = 0; i < N_EVENTS; i++){
+            runs[i] = 0;
+            dones[i] = sch->every(1)->independent()->do_([i](){ results[i] = work(results[i] + i); runs[i]++; });
+        }
+        unsigned long counted = 0, calls = 0;
+        unsigned long* out = &counted;
+        sch->every(1)->independent()->do_([calls, out]() mutable { *out = ++calls; }); // Counts in its Own Capture
+
+        auto start = std::chrono::steady_clock::now();
+        for(int p = 0; p < N_PASSES; p++){
+            bench_now++;
+            sch->loop();
+            for(int i = 0; i < N_EVENTS; i++){ // The Barrier Ends each Pass
+                if(runs[i] != runs[0] || (runs[i] > 0 && !dones[i].get())){ failures++; }
+            }
+        }
+        if(runs[0] != N_PASSES - 1){ failures++; } // Every(1) First Fires on the Second Pass
+        if(counted != runs[0]){
+            pl("FAIL: " << n << " threads: counted " << counted << " of " << runs[0] << " runs");
+            failures++;
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if(n == 0){ base_ms = ms; }
+        pl(n << ',' << N_PASSES << ',' << ms << ',' << base_ms / ms);
+        sch->useThreads(0);
+    }
+    pl((failures ? "FAILED" : "PASSED"));
+    return failures ? 1 : 0;
+}
+#endif
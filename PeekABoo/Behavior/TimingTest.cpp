@@ -0,0 +1,151 @@
+#ifdef _CFCT_ // Compiling for g++ Testing (keeps avr-gcc from bugging about this file)
+/* Host Test of Schedule Timing across the Wrap of the 32-bit Clock. Fast
+ * forwards a simulated clock from just before the wrap to well past it, then
+ * checks how soon ready events run, how time-budgeted passes share out and
+ * what each overrun policy does about a timer which was held up.
+ * Build: g++ -D_CFCT_ -o timing TimingTest.cpp
+ */
+#include <iostream>
+#include <stdint.h>
+static uint32_t sim_now = 0xFFFFFFFFUL - 2999; // Wraps 3s into the Test
+unsigned long millis(){ return sim_now; }
+static unsigned long sim_us = 0; // Time Spent in Actions (for Pass Budgets) [us]
+#define SCHEDULE_PASS_CLOCK() sim_us
+#include "Schedule.h"
+
+#define pl(x) std::cout << x << std::endl
+
+int failures = 0;
+#define CHECK(name, got, expected) \
+if((got) != (expected)){ pl("FAIL: " << name << " = " << (got) << ", expected " << (expected)); failures++; } \
+else{ pl("ok: " << name << " = " << (got)); }
+
+unsigned int n_every = 0, n_in = 0, n_while = 0, n_static = 0;
+uint32_t in_fired_at = 0;
+bool inWindow(){ return sim_now >= 1000 && sim_now < 2000; } // 1-2s after the Wrap
+void countStatic(){ n_static++; }
+Schedule* chain_sch;
+unsigned long chain = 0;
+void link(){ chain++; if(chain_sch){ chain_sch->NOW->do_(link); } } // Queues Itself till Told to Stop
+unsigned long heavy_runs[9];
+unsigned long policy_runs[3];
+
+int main(){
+    Schedule* sch = new Schedule();
+    sch->every(10)->do_([](){ n_every++; });
+    sch->in_(5000)->do_([](){ n_in++; in_fired_at = sim_now; });
+    sch->everyWhile(100, inWindow)->do_([](){ n_while++; });
+    StaticSchedule< Every<10, countStatic> > fixed;
+
+    CHECK("idle before first timer", sch->idleTime(1000), 11u);
+
+    for(int i = 0; i < 6000; i++){ // Simulate 6s, 1ms per Pass
+        sim_now++;
+        sch->loop();
+        fixed.loop();
+    }
+
+    CHECK("every(10) firings", n_every, 599u);
+    CHECK("static Every<10> firings", n_static, 599u);
+    CHECK("in_(5000) firings", n_in, 1u);
+    CHECK("in_(5000) fired at", in_fired_at, 2001u);
+    CHECK("everyWhile(100) firings", n_while, 9u);
+    CHECK("idle after the wrap", sch->idleTime(1000), 1u);
+
+    // Ready Queue: NOWs and #call-s from an action run later in the same pass,
+    // but a chain of them which never ends is cut off at the budget.
+    static unsigned long ran_in_pass = 0, called_in_pass = 0;
+    static TimedEvent* later = sch->every(60000);
+    later->do_([sch](){ called_in_pass = sch->passes; });
+    sch->in_(0)->do_([sch](){
+        sch->NOW->do_([sch](){ ran_in_pass = sch->passes; });
+        later->call();
+    });
+    sim_now++;
+    sch->loop(); // in_(0) is Due now
+    CHECK("NOW ran in the pass it was made", ran_in_pass, sch->passes);
+    CHECK("call ran in the pass it was made", called_in_pass, sch->passes);
+    chain_sch = sch;
+    sch->NOW->do_(link);
+    sch->loop();
+    CHECK("NOW chain cut off at the budget", chain, (unsigned long) SCHEDULE_READY_BUDGET);
+    CHECK("passes deferring ready events", sch->ready_deferrals, 1ul);
+    CHECK("idle with ready events", sch->idleTime(1000), 0u);
+    chain_sch = nullptr; // Ends the Chain
+    sch->loop();
+
+    // Long Ready Queue: 20000 NOWs queued at once run in the order they were
+    // queued, SCHEDULE_READY_BUDGET a pass (and popping them doesn't shift
+    // the rest of the queue each time, so this stays quick).
+    static unsigned long queued_runs = 0, queued_out_of_order = 0;
+    for(unsigned long i = 0; i < 20000; i++){
+        sch->NOW->do_([i](){
+            if(i != queued_runs){ queued_out_of_order++; }
+            queued_runs++;
+        });
+    }
+    sch->loop();
+    CHECK("queued NOWs run in the first pass", queued_runs, (unsigned long) SCHEDULE_READY_BUDGET);
+    for(int i = 0; i < 20000 / SCHEDULE_READY_BUDGET; i++){
+        sch->loop();
+    }
+    CHECK("queued NOWs run", queued_runs, 20000ul);
+    CHECK("queued NOWs out of order", queued_out_of_order, 0ul);
+
+    // Budgeted Passes: 9 actions of 300us which all want to run every pass
+    // get 1000us a pass, so each pass stops after 4 (the one which goes over
+    // can't be cut short), and every action still gets the same share.
+    Schedule* budgeted = new Schedule();
+    for(int i = 0; i < 9; i++){
+        if(i < 6){
+            budgeted->every(1)->do_([i](){ heavy_runs[i]++; sim_us += 300; });
+        } else{
+            budgeted->while_([](){ return true; })->do_([i](){ heavy_runs[i]++; sim_us += 300; });
+        }
+    }
+    unsigned long longest = 0;
+    for(int i = 0; i < 900; i++){
+        sim_now++;
+        unsigned long start = sim_us;
+        budgeted->loop(1000);
+        if(sim_us - start > longest){ longest = sim_us - start; }
+    }
+    unsigned long fewest = heavy_runs[0], most = heavy_runs[0];
+    for(int i = 1; i < 9; i++){
+        if(heavy_runs[i] < fewest){ fewest = heavy_runs[i]; }
+        if(heavy_runs[i] > most){ most = heavy_runs[i]; }
+    }
+    CHECK("longest budgeted pass", longest, 1200ul);
+    CHECK("fairest share", most - fewest <= 1, true);
+    CHECK("every action ran", fewest > 350, true);
+    CHECK("budget overruns", budgeted->budget_overruns, 899ul); // The First Pass only has the WHILEs
+    CHECK("worst overrun", budgeted->worst_overrun, 200ul);
+
+    // Overrun Policies: a blocking action holds the schedule up for 105ms
+    // (from +4 to +109), and then the every(10)s either catch up on every
+    // deadline one pass at a time, run once and stay in phase, or run once
+    // and go on from there.
+    Schedule* late = new Schedule();
+    static TimedEvent* policies[3];
+    for(int i = 0; i < 3; i++){
+        policies[i] = late->every(10)->onOverrun(i == 0 ? TimedEvent::CATCH_UP : i == 1 ? TimedEvent::SKIP_MISSED : TimedEvent::REALIGN);
+        policies[i]->do_([i](){ policy_runs[i]++; });
+    }
+    uint32_t start = sim_now;
+    late->in_(3)->do_([](){ sim_now += 105; });
+    for(int i = 0; i < 20; i++){
+        sim_now++;
+        late->loop();
+    }
+    CHECK("catch-up runs", policy_runs[0], 12ul); // For +10, ..., +120 (it's now +125)
+    CHECK("skip-missed runs", policy_runs[1], 3ul); // For +10 (at +110), +110 and +120
+    CHECK("realign runs", policy_runs[2], 2ul); // At +110 and +121
+    CHECK("catch-up missed", policies[0]->missed, 10ul); // Runs which were Already a Deadline Behind
+    CHECK("skip-missed missed", policies[1]->missed, 9ul); // +20, ..., +100
+    CHECK("skip-missed deadline", policies[1]->deadline - start, 130u);
+    CHECK("realign deadline", policies[2]->deadline - start, 131u);
+
+    pl((failures ? "FAILED" : "PASSED"));
+    return failures ? 1 : 0;
+}
+#endif
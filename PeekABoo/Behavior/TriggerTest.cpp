@@ -0,0 +1,183 @@
+#ifdef _CFCT_ // Compiling for g++ Testing (keeps avr-gcc from bugging about this file)
+/* Host Test of Schedule#trigger and PinEdgeEvents. A producer thread stands
+ * in for an interrupt and hammers two Events through the trigger queue while
+ * the main thread loops the Schedule, then the two play ping-pong to bound
+ * the latency of a trigger which arrives while the Schedule is sleeping.
+ * Finally, edges are injected into PinEdgeEvents as their interrupts would
+ * (pulses shorter than a pass, bursts, and a thread hammering them), and
+ * Events which nothing polls are called directly.
+ * Build: g++ -std=gnu++11 -D_CFCT_ -pthread -o trigger TriggerTest.cpp
+ */
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <string>
+#include <time.h>
+#include <stdint.h>
+unsigned long millis(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000UL + ts.tv_nsec / 1000000UL;
+}
+#include "Schedule.h"
+
+#define pl(x) std::cout << x << std::endl
+
+int failures = 0;
+#define CHECK(name, got, expected) \
+if((got) != (expected)){ pl("FAIL: " << name << " = " << (got) << ", expected " << (expected)); failures++; } \
+else{ pl("ok: " << name << " = " << (got)); }
+
+const unsigned long N = 100000; // Triggers of each Event
+
+Schedule* sch = new Schedule();
+std::atomic<unsigned long> n_a(0), n_b(0);
+unsigned long out_of_order = 0;
+bool expect_a = true; // The Producer Alternates A and B, so they should Run Alternately
+
+int main(){
+    Event* A = sch->onTrigger();
+    Event* B = sch->onTrigger();
+    A->do_([](){ if(!expect_a){ out_of_order++; } expect_a = false; n_a++; });
+    B->do_([](){ if(expect_a){ out_of_order++; } expect_a = true; n_b++; });
+    Event* tick = sch->every(1);
+    tick->do_([](){ }); // Other Work for the Loop
+
+    // Hammer: retry whenever the queue is full (where an interrupt would have
+    // to drop it), yielding so this works on a single core too.
+    unsigned long retries = 0;
+    std::thread producer([&](){
+        for(unsigned long i = 0; i < N; i++){
+            while(!sch->trigger(A)){ retries++; std::this_thread::yield(); }
+            while(!sch->trigger(B)){ retries++; std::this_thread::yield(); }
+        }
+    });
+    while(n_a < N || n_b < N){
+        sch->loop();
+        std::this_thread::yield();
+    }
+    producer.join();
+    sch->loop();
+
+    CHECK("A runs", n_a.load(), N);
+    CHECK("B runs", n_b.load(), N);
+    CHECK("runs out of order", out_of_order, 0ul);
+    CHECK("overflows counted", sch->trigger_overflows, retries);
+    pl("(" << retries << " triggers found the queue full)");
+
+    // Ping-Pong: the main thread sleeps in #loopUntilNextDeadline with nothing
+    // due for a minute, and each trigger should still run within a few ms.
+    tick->cancel();
+    sch->in_(60000);
+    Event* PING = sch->onTrigger();
+    std::atomic<unsigned long> pongs(0);
+    PING->do_([&](){ pongs++; });
+    std::atomic<bool> stop(false);
+    unsigned long worst = 0;
+    std::thread pinger([&](){
+        for(unsigned long i = 0; i < 50; i++){
+            struct timespec ts = {0, 2000000L}; // Let the Schedule fall asleep
+            nanosleep(&ts, nullptr);
+            unsigned long start = millis();
+            sch->trigger(PING);
+            while(pongs <= i){ std::this_thread::yield(); }
+            if(millis() - start > worst){ worst = millis() - start; }
+        }
+        stop = true;
+        sch->wake();
+    });
+    while(!stop){
+        sch->loopUntilNextDeadline();
+    }
+    pinger.join();
+
+    CHECK("pongs", pongs.load(), 50ul);
+    CHECK("worst latency under 100ms", worst < 100, true);
+    pl("(worst latency " << worst << "ms)");
+
+    // Pin Edges: a pulse which comes and goes between two passes is still
+    // caught (once, on the edge asked for) with the time it happened.
+    PinEdgeEvent* falling = sch->onPinEdge(2, PinEdgeEvent::FALLING_EDGE);
+    PinEdgeEvent* both = sch->onPinEdge(3);
+    static unsigned long n_falling = 0, fell_at = 0;
+    static std::string edges;
+    falling->do_([falling](){ n_falling++; fell_at = falling->time; });
+    both->do_([both](){ edges += both->rising ? 'R' : 'F'; edges += std::to_string(both->time); edges += ' '; });
+    sch->loop();
+    falling->inject(false, 1000);
+    falling->inject(true, 1040); // 40us Pulse
+    both->inject(true, 2000);
+    both->inject(false, 2010);
+    CHECK("idle with edges waiting", sch->idleTime(1000), 0ul);
+    sch->loop();
+    CHECK("falling edges", n_falling, 1ul);
+    CHECK("fell at", fell_at, 1000ul);
+    CHECK("both edges", edges, std::string("R2000 F2010 "));
+    for(unsigned long i = 0; i < 10; i++){ // Burst bigger than the ring
+        falling->inject(false, 3000 + i);
+    }
+    sch->loop();
+    CHECK("burst delivered", n_falling, 1ul + SCHEDULE_EDGE_QUEUE - 1);
+    CHECK("burst overflows", falling->overflows, 10ul - (SCHEDULE_EDGE_QUEUE - 1));
+
+    // Hammer: the thread stands in for the pin's interrupt.
+    n_falling = 0;
+    unsigned long overflows_before = falling->overflows;
+    std::atomic<bool> injected(false);
+    std::thread pin([&](){
+        for(unsigned long i = 0; i < N; i++){
+            falling->inject(false, i);
+            if(i % 4 == 0){ std::this_thread::yield(); }
+        }
+        injected = true;
+    });
+    while(!injected){
+        sch->loop();
+        std::this_thread::yield();
+    }
+    pin.join();
+    sch->loop();
+    CHECK("edges delivered or counted", n_falling + (falling->overflows - overflows_before), N);
+    pl("(" << falling->overflows - overflows_before << " edges overflowed)");
+    falling->cancel();
+    sch->loop();
+    CHECK("cancelled edge events", sch->pin_events.size(), 1ul);
+
+    // Direct Calls: calling an Event which no list polls (an onTrigger or a
+    // PinEdgeEvent) runs it from the ready queue, later in the same pass when
+    // an action calls it, and cancelling it first drops the call.
+    Event* called = sch->onTrigger();
+    static unsigned long n_called = 0, called_in = 0;
+    called->do_([](){ n_called++; called_in = sch->passes; });
+    called->call();
+    sch->loop();
+    CHECK("called onTrigger runs", n_called, 1ul);
+    sch->NOW->do_([called](){ called->call(); });
+    sch->loop();
+    CHECK("called from an action", n_called, 2ul);
+    CHECK("in the same pass", called_in, sch->passes);
+    both->call();
+    sch->loop();
+    CHECK("called edge event", edges, std::string("R2000 F2010 F2010 "));
+    called->call();
+    called->cancel();
+    sch->loop();
+    CHECK("call dropped on cancel", n_called, 2ul);
+
+    // Triggered then Freed: a trigger of an Event which is freed before it
+    // runs (a paused WHEN is freed as soon as it's cancelled) is dropped
+    // rather than left pointing at it.
+    static unsigned long n_freed = 0;
+    ConditionalEvent* parked = sch->when([](){ return true; });
+    parked->do_([](){ n_freed++; });
+    parked->pause();
+    sch->loop(); // Parks it
+    sch->trigger(parked);
+    parked->cancel();
+    sch->loop();
+    CHECK("trigger of a freed event", n_freed, 0ul);
+
+    pl((failures ? "FAILED" : "PASSED"));
+    return failures ? 1 : 0;
+}
+#endif
@@ -43,6 +43,10 @@
  */
 
 void setup(){
+#ifdef RECORD_SENSORS
+  Serial.begin(115200);
+  sch->EVERY(20)->do_([](){ sensor_log.flush(Serial); });
+#endif
   initHAL();
   moveStalks(0);
   moveHands(0);
@@ -53,11 +57,11 @@ void setup(){
 
   sch->EVERY_WHILE(2000, dist() > 20)->DO(togglePeek());
 
-  sch->WHILE(dist() < 20)->DO(moveHands(100));
+  sch->WHILE(dist() < 20)->reactive()->DO(moveHands(100));
   sch->EVERY_WHILE(700, dist() < 20)->DO(moveStalkLeft(100));
   sch->EVERY_WHILE(1000, dist() < 20)->DO(moveStalkRight(100));
 
-  sch->WHEN(touched())->DO(uncoverEyes(); chuckle(); coverEyes(););
+  sch->WHEN(touched())->reactive()->DO_RESUMABLE(uncoverEyes(); AWAIT(chuckle()); coverEyes(););
 
 } // #setup
 
@@ -2,22 +2,276 @@
  * Intuitive Scheduling Utility that Allows for Complex Time and Condition Based
  * Behaviors to be Constructed out of Simple, Legible Event-Based Primitives.
  * (admittedly, this has a bit of a ways to go in terms of memory efficiency -
- * badly needs a ring buffer. (especially bad now that state persistence has
+ * one-shot events now live in a fixed ring of slots but Actions are still
+ * allocated individually. (especially bad now that state persistence has
  * been added))
  * KNOWN BUGS / PROBLEMS:
- *  - Semi-Required memory leak on the %done% state of Actions. Need to have
- * some way of determining whether / how long other functions will need access to
- * this information after the Action has been deleted. NOTE: Until this is fixed,
- * the ability to create unbounded series of SingleTimedEvents with #in_ is
- * gone. Keep total number of events known and bounded.
+ *  - The %done% state of Actions lives in a fixed pool of ActionState slots
+ * (see SCHEDULE_ACTION_STATES). If every slot is held, new Actions get a null
+ * state which never reads as done (counted in ActionState::overflows()).
  * Author: Connor W. Colombo, 9/21/2018
- * Version: 0.1.4
+ * Version: 0.1.28
  * License: MIT
  */
 #ifndef SCHEDULE_H
 #define SCHEDULE_H
+#ifndef _CFCT_ // Not Needed (or Available) when Compiling for g++ Testing
 #include <StandardCplusplus.h>
+#endif
 #include <vector>
+#include <new>
+#include <stdint.h>
+#include <string.h>
+#if defined(_CFCT_)
+#include <time.h>
+#ifdef SCHEDULE_THREADS
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#endif
+#elif defined(__AVR__)
+#include <avr/sleep.h>
+#endif
+
+// Number of One-Shot (IN / NOW) Events which can be Pending at Once without
+// Touching the Heap. Override by defining this before including Schedule.h.
+// Once all slots are taken, #in_ falls back to allocating the Event with new
+// (and counts it in Schedule::oneshot_overflows).
+#ifndef SCHEDULE_ONESHOT_SLOTS
+#define SCHEDULE_ONESHOT_SLOTS 4
+#endif
+
+// Number of ActionStates (completion flags of Actions and any states made with
+// new_ActionState) which can Exist at Once. Override by defining this before
+// including Schedule.h. Must be < 254.
+#ifndef SCHEDULE_ACTION_STATES
+#define SCHEDULE_ACTION_STATES 24
+#endif
+
+// Number of Continuations (see ActionState#then, when_all, when_any) which can
+// be Waiting at Once. Override by defining this before including Schedule.h.
+// Must be < 255.
+#ifndef SCHEDULE_CONTINUATIONS
+#define SCHEDULE_CONTINUATIONS 8
+#endif
+
+// Number of Slots in the Ring Buffer which Carries Schedule#trigger Calls (from
+// interrupts or another thread) to the next #loop. One slot is always kept
+// empty, so this many minus one triggers can be pending at once. Override by
+// defining this before including Schedule.h. Must be <= 256.
+#ifndef SCHEDULE_TRIGGER_QUEUE
+#define SCHEDULE_TRIGGER_QUEUE 16
+#endif
+
+// Number of Events from the Ready Queue (NOW events and TimedEvents which were
+// #call-ed) a single #loop will Run. Anything queued beyond that (eg. by
+// actions which keep queueing more) waits for the next pass. Override by
+// defining this before including Schedule.h.
+#ifndef SCHEDULE_READY_BUDGET
+#define SCHEDULE_READY_BUDGET 16
+#endif
+
+// Number of Bytes a SensorLog Keeps between Flushes. Override by defining this
+// before including Schedule.h.
+#ifndef SCHEDULE_LOG_SIZE
+#define SCHEDULE_LOG_SIZE 128
+#endif
+
+// State Shared by every Schedule (the ActionState pool, the VirtualClock, etc.)
+// is Kept per Thread on the Host, so each thread can run its own Schedules
+// (see BatchSim.cpp). There's only one thread on the boards.
+#ifdef _CFCT_
+#define SCHEDULE_THREAD_LOCAL thread_local
+#else
+#define SCHEDULE_THREAD_LOCAL
+#endif
+
+// Number of Pins which can have Edge Events (see Schedule#onPinEdge) at Once
+// (each takes an interrupt), and the Number of Edges on each which can be
+// Waiting for the Next #loop. Override by defining these before including
+// Schedule.h. SCHEDULE_EDGE_QUEUE must be <= 256. Edges are timestamped with
+// SCHEDULE_EDGE_CLOCK() (micros() unless defined otherwise).
+#ifndef SCHEDULE_PIN_EDGES
+#define SCHEDULE_PIN_EDGES 2
+#endif
+#ifndef SCHEDULE_EDGE_QUEUE
+#define SCHEDULE_EDGE_QUEUE 8
+#endif
+#ifndef SCHEDULE_EDGE_CLOCK
+#define SCHEDULE_EDGE_CLOCK() micros()
+#endif
+
+// Host Only (g++ with -pthread): define SCHEDULE_THREADS before including
+// Schedule.h to let a Schedule hand the actions of Events marked
+// Event#independent to a pool of worker threads (see Schedule#useThreads).
+// Nothing changes on the boards.
+
+// Timebase of every Timed Event. By default, time is read from millis() and
+// every interval is in milliseconds. Define SCHEDULE_MICROS before including
+// Schedule.h to use micros() instead (every interval is then in microseconds).
+// Times are 32 bits and wrap just like millis() / micros() do on the boards
+// (even on the host) and are always compared on their signed difference, so
+// they stay correct across the wrap as long as no interval is longer than
+// half the range (~24 days in ms, ~35 minutes in us). Define SCHEDULE_TIME_64
+// to extend the clock to 64 bits instead (the Schedule must then be looped at
+// least once per wrap of the underlying clock).
+// Any other clock can be plugged in by defining SCHEDULE_RAW_CLOCK() (and
+// SCHEDULE_TICKS_PER_MS) before including Schedule.h. Define
+// SCHEDULE_VIRTUAL_CLOCK to use a VirtualClock which only moves when told to
+// (for deterministic simulations on the host, see Schedule::simulate).
+#if defined(SCHEDULE_VIRTUAL_CLOCK)
+#define SCHEDULE_RAW_CLOCK() VirtualClock::now()
+#elif !defined(SCHEDULE_RAW_CLOCK)
+#ifdef SCHEDULE_MICROS
+#define SCHEDULE_RAW_CLOCK() micros()
+#else
+#define SCHEDULE_RAW_CLOCK() millis()
+#endif
+#endif
+#ifndef SCHEDULE_TICKS_PER_MS
+#ifdef SCHEDULE_MICROS
+#define SCHEDULE_TICKS_PER_MS 1000UL
+#else
+#define SCHEDULE_TICKS_PER_MS 1UL
+#endif
+#endif
+#ifdef SCHEDULE_TIME_64
+typedef uint64_t schedule_time_t;
+typedef int64_t schedule_diff_t;
+#else
+typedef uint32_t schedule_time_t;
+typedef int32_t schedule_diff_t;
+#endif
+
+#ifdef SCHEDULE_VIRTUAL_CLOCK
+/*
+ * Clock which Only Moves when Told to. Schedules sleeping on it (in
+ * #loopUntilNextDeadline or #simulate) jump it straight to their next
+ * deadline, so hours of behavior run in as long as their events take to
+ * execute and every run gives the same trace.
+ */
+class VirtualClock{
+public:
+    // Returns the Current Virtual Time (in ticks):
+    static unsigned long now(){ return time(); }
+    // Moves the Clock Forward by %t% Ticks:
+    static void advance(unsigned long t){ time() += t; }
+    // Sets the Clock to the Given Time:
+    static void set(unsigned long t){ time() = t; }
+
+private:
+    static unsigned long& time(){
+        static SCHEDULE_THREAD_LOCAL unsigned long t = 0;
+        return t;
+    } // #time
+}; // class VirtualClock
+#endif
+
+/* Returns the Current Time in the Schedule's Timebase. */
+inline schedule_time_t scheduleNow(){
+#ifdef SCHEDULE_TIME_64
+    static SCHEDULE_THREAD_LOCAL uint64_t extended = 0;
+    static SCHEDULE_THREAD_LOCAL uint32_t last = 0;
+    uint32_t raw = (uint32_t) SCHEDULE_RAW_CLOCK();
+    extended += (uint32_t)(raw - last); // Carries every wrap of the raw clock
+    last = raw;
+    return extended;
+#else
+    return (schedule_time_t) SCHEDULE_RAW_CLOCK();
+#endif
+} // #scheduleNow
+
+/* Returns Whether Time %now% is Strictly After %deadline% (wrap-safe). */
+inline bool timePassed(schedule_time_t now, schedule_time_t deadline){
+    return (schedule_diff_t)(now - deadline) > 0;
+} // #timePassed
+
+/* Returns the Time Pass Budgets (see Schedule#loop) are Measured in
+ (microseconds, unless SCHEDULE_PASS_CLOCK() is defined to read something else). */
+inline unsigned long passMicros(){
+#if defined(SCHEDULE_PASS_CLOCK)
+    return SCHEDULE_PASS_CLOCK();
+#elif defined(_CFCT_)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000UL + ts.tv_nsec / 1000;
+#else
+    return micros();
+#endif
+} // #passMicros
+
+// Define SCHEDULE_PROFILE before including Schedule.h to have every Event keep
+// an EventProfile (trigger count, time spent in its actions and, for timed
+// events, how late they fire) which Schedule::dumpProfile can print. Without
+// it, none of this is compiled in.
+#ifdef SCHEDULE_PROFILE
+// Number of Buckets in each Lateness Histogram:
+#ifndef SCHEDULE_PROFILE_BINS
+#define SCHEDULE_PROFILE_BINS 8
+#endif
+
+/* Returns the Time Action Durations are Measured in (microseconds, unless
+ SCHEDULE_PROFILE_CLOCK() is defined to read something else). */
+inline unsigned long profileNow(){
+#if defined(SCHEDULE_PROFILE_CLOCK)
+    return SCHEDULE_PROFILE_CLOCK();
+#elif defined(_CFCT_)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000UL + ts.tv_nsec / 1000;
+#else
+    return micros();
+#endif
+} // #profileNow
+
+/* Statistics Kept about each Event when SCHEDULE_PROFILE is Defined. */
+struct EventProfile{
+    unsigned long triggers = 0; // Number of Times its Actions were Run
+    unsigned long total_time = 0; // Total Time Spent Running its Actions [us]
+    unsigned long max_time = 0; // Longest Time Spent Running its Actions at Once [us]
+    // Lateness Histogram [ticks after the earliest it could have fired]:
+    // bucket 0 is on time, bucket b counts lateness in [2^(b-1), 2^b) and the
+    // last bucket everything beyond.
+    unsigned int lateness[SCHEDULE_PROFILE_BINS] = {0};
+
+    /* Records one Run of the Actions which took %t% us. */
+    void ran(unsigned long t){
+        this->triggers++;
+        this->total_time += t;
+        if(t > this->max_time){ this->max_time = t; }
+    } // #ran
+
+    /* Records one Firing %t% Ticks Late. */
+    void late(schedule_time_t t){
+        unsigned char b = 0;
+        while(t > 0 && b < SCHEDULE_PROFILE_BINS - 1){
+            t >>= 1;
+            b++;
+        }
+        this->lateness[b]++;
+    } // #late
+
+    /* Adds the Given Profile's Statistics into this One. */
+    void merge(const EventProfile& other){
+        this->triggers += other.triggers;
+        this->total_time += other.total_time;
+        if(other.max_time > this->max_time){ this->max_time = other.max_time; }
+        for(unsigned char b = 0; b < SCHEDULE_PROFILE_BINS; b++){
+            this->lateness[b] += other.lateness[b];
+        }
+    } // #merge
+}; // struct EventProfile
+#endif
+
+// Number of Bytes of Captured State an InlineFunction (the callables given to
+// do_, when, while_, etc.) can Hold. Override by defining this before
+// including Schedule.h.
+#ifndef SCHEDULE_CALLABLE_SIZE
+#define SCHEDULE_CALLABLE_SIZE (4*sizeof(void*))
+#endif
+
 /* Example Usage (only call these once, likely in setup):
  ** avoid calling variables directly from inside these functions unless they are global variables **
 
@@ -28,7 +282,7 @@
 
  sch->IN(2500)->DO(doThisOnce()); // Will call #doThisOnce one time in 2.5s
 
- sch->NOW->DO(sortOfUrgent()); // Will call #sortOfUrgent as soon as possible without blocking other events (useful in comm. interrupts for longer behavior)
+ sch->NOW->DO(sortOfUrgent()); // Will call #sortOfUrgent as soon as possible without blocking other events (NOT from interrupts, see below)
 
  sch->WHILE(dist < 10)->DO(swing_arms()); // Will call #swing_arms as often as possible as long as dist < 10.
  sch->WHEN(dist > 10)->DO(someOtherThing()); // Will call #someOtherThing every time dist goes from <=10 to >10.
@@ -38,6 +292,32 @@
  sch->EVERY(250)->do_(blink); // if you're just calling a void function with no arguments, it's more effective to just use the lowercase #do_
  // Note:
  sch->EVERY(100)->DO(x++); // x or other variables accessed directly must be a global variables (not local scope)
+ // To use local state, pass a lambda which captures it (by value) to the lowercase functions instead:
+ int n = 0;
+ sch->EVERY(100)->do_([n]() mutable { n++; });
+ sch->when([n](){ return dist() < n; })->do_(blink);
+
+ // Sensors which are Slow to Read (or Read by Many Conditions) can be Sampled
+ // at most Once per Pass (and optionally at most once every so many ms):
+ Signal<float>* distance = sch->sample([](){ return sonar.measureDistanceCm(); }, 50);
+ sch->WHILE(distance->read() < 20)->DO(moveHands(100)); // All readers share one ping per pass
+
+ // Conditions which Only Read Signals and States can be made Reactive, so they
+ // are only re-evaluated when something they read changes (not every pass):
+ State<bool> eyes_covered; // ... elsewhere: eyes_covered.set(true);
+ sch->WHEN(eyes_covered.get() && touched())->reactive()->DO(chuckle());
+
+ // Edges on Pins with External Interrupts (not pin-change interrupts) can
+ // Trigger Events Directly (so even pulses shorter than a pass are caught),
+ // with the micros() of each Edge:
+ PinEdgeEvent* confirm = sch->onPinEdge(CONFIRM_PIN, PinEdgeEvent::FALLING_EDGE);
+ confirm->do_([confirm](){ Serial.println(confirm->time); });
+
+ // Interrupts mustn't make Events (or touch anything else which allocates), so
+ // make one ahead of time and trigger it instead (runs on the next pass):
+ Event* RECEIVED = sch->onTrigger();
+ RECEIVED->DO(readPacket());
+ // ... in the interrupt: sch->trigger(RECEIVED);
 
  // Or Save Events to be Registered to Later:
  Event* FREQ_100Hz = schedule->EVERY(10);
@@ -47,26 +327,86 @@
  TOO_CLOSE->SIGNUP(tone(BUZZER, 1000, 25));
 
  // Additionally, events which setup other events (using nested actions) return
- // a double pointer to a bool which indicates when all sub-events have been
- // executed at least once.
- // Note: bool** beepboopd must be global.
- beepboopd = sch->IN(3100)->DO_LONG( *(sch->IN(1000)->DO( plt("***BEEP***BOOP***"); )); );
- sch->WHEN(**beepboopd)->DO( plt("## BOP ##"); );
+ // an ActionState which indicates when all sub-events have been executed at
+ // least once.
+ // Note: ActionState beepboopd must be global.
+ beepboopd = sch->IN(3100)->DO_LONG( sch->IN(1000)->DO( plt("***BEEP***BOOP***"); ) );
+ beepboopd.then([](){ plt("## BOP ##"); }); // Runs the moment it's done (nothing polls it)
+ when_all(blink(), chuckle()).then(coverEyes); // Or once all (when_any: any) of several are done
+ }
+
+ // Events can be Switched Off for a While, or for Good:
+ Event* peeking = sch->EVERY_WHILE(750, dist() < 10);
+ peeking->DO(togglePeek());
+ peeking->pause(); // ... later: peeking->resume();
+ peeking->cancel(); // Frees it (don't use the pointer after this)
+
+ // If the Events Never Change, a StaticSchedule does the Same Job with No Heap
+ // and No Virtual Calls (functions must be named, not lambdas):
+ StaticSchedule< Every<500, blink>, EveryWhile<750, tooClose, togglePeek>, When<touched, uncoverEyes> > fixed;
+ void loop(){
+ fixed.loop();
+ }
+
+ // Behaviors which Take a While (and would otherwise call delay) can be Written
+ // as Resumable Tasks which give the Schedule back while they Wait:
+ sch->WHEN(touched())->DO_RESUMABLE( coverEyes(); WAIT(500); moveStalks(0); );
+ // ... or Spawned Directly (returning an ActionState which is done once they finish):
+ ActionState chuckle(){
+   return sch->spawn([](Task* task){
+     TASK_BEGIN;
+     AWAIT(invertBlink()); // Waits for another Task to Finish
+     moveStalks(80);
+     WAIT_UNTIL(!touched());
+     TASK_END;
+   });
+ }
+
+ // With SCHEDULE_PROFILE Defined, every Event Counts its Runs, Time Spent and
+ // Lateness, and the Table can be Streamed out in the Field:
+ sch->EVERY(20)->named("stepper")->DO(stepper.run());
+ sch->EVERY(60000)->DO(sch->dumpProfile(Serial));
+
+ // Events which Must Never Wait Long (stepping motors, etc.) can be Made
+ // Critical: they're serviced between every other event that runs in a pass:
+ sch->ALWAYS->critical()->DO(stepper.run());
+
+ // Timed Events which Fall Behind (after a long action, say) Run once every
+ // Pass until they've Caught up, unless Told Otherwise:
+ sch->EVERY(200)->onOverrun(TimedEvent::REALIGN)->DO(sendTelemetry()); // Sends once when late, then every 200ms from then
+ sch->EVERY(10)->onOverrun(TimedEvent::SKIP_MISSED)->DO(readIMU()); // Reads once when late, and stays on the 10ms grid
+
+ // A Piece with Mostly Timed Events can Sleep between them instead of Spinning:
+ void loop(){
+ sch->loopUntilNextDeadline(20); // Poll any conditions at least every 20ms
+ }
+
+ // If Several Heavy Behaviors can Fire Together, Passes can be Given a Time
+ // Budget, and whatever doesn't fit Runs on the Next Pass (in turn):
+ void loop(){
+ sch->loop(2000); // Stop dispatching once this pass has taken 2ms
  }
+
+ // On the Host, with SCHEDULE_VIRTUAL_CLOCK defined, an Hour of Behavior can be
+ // Fast-Forwarded in Moments (deterministically):
+ sch->simulate(3600000UL);
  */
 
-/* NB: Some functionality must be assigned in macros b/c lambdas with captures
- can't be converted to function pointers. */
+/* NB: The macros wrap their arguments in captureless lambdas, so anything they
+ touch must be global. Capturing lambdas can be given to the lowercase functions
+ directly (see InlineFunction). */
 // More Legible Shorthand for "do_" syntax:
 #define DO(x) do_([](){x;})
 /* Shorthand for Calling a Function which Takes a Long Time to Complete after it
- Returns (has its own event calls) and returns a double pointer of a boolean which
- indicates when it is done. */
+ Returns (has its own event calls) and returns an ActionState which indicates
+ when it is done (%x% must give the ActionState of the last sub-event). */
 #define DO_LONG(x) \
 do_(new NestingAction([](Action* action){ \
-delete action->done; \
-action->done = x; \
-}));
+action->done.follow(x); \
+}))
+/* Shorthand for Performing an Action which can WAIT (see Task) without Blocking
+ the Schedule. Triggers while it's still running are ignored. */
+#define DO_RESUMABLE(x) resumable([](Task* task){ TASK_BEGIN; x; TASK_END; })
 // More Legible Shorthand for "do_" syntax:
 #define SIGNUP(x) signup([](){x;})
 // More Legible Shorthand for "while_" syntax:
@@ -79,30 +419,450 @@ action->done = x; \
 #define EVERY_WHILE(x,y) everyWhile(x, [](){return (y);})
 // Syntax to Normalize All-Caps Syntax used by Conditionals:
 #define IN(x) in_(x)
-// Shorthand Syntax for Performing a Task as Soon as Possible:
-#define NOW in_(0)
+// Shorthand Syntax for Performing a Task as Soon as Possible (later in the
+// same pass, if called from an action):
+#define NOW now_()
+// Shorthand Syntax for Performing a Task as Frequently as Possible:
+#define ALWAYS EVERY(1)
+
+/* Protothread-Style Syntax for the Bodies of Resumable Tasks (see Task). A body
+ is wrapped in TASK_BEGIN; ... TASK_END; and can yield back to the Schedule with: */
+#define TASK_BEGIN switch(task->line){ case 0:
+#define TASK_END } task->finish()
+// Resumes %t% Milliseconds (ticks) from Now:
+#define WAIT(t) WAIT_AT_(t, __COUNTER__ + 1)
+// Resumes once %c% is True (checked every pass):
+#define WAIT_UNTIL(c) WAIT_UNTIL_AT_(c, __COUNTER__ + 1)
+// Resumes once the ActionState %s% is Done (ie. another Task has Finished):
+#define AWAIT(s) do{ task->pending = (s); WAIT_UNTIL(task->pending.get()); }while(0)
+#define WAIT_AT_(t, n) do{ task->sleepFor(t); task->line = (n); return; case (n):; }while(0)
+#define WAIT_UNTIL_AT_(c, n) do{ task->line = (n); if(false){ case (n):; } if(!(c)){ task->poll(); return; } }while(0)
+
+/*
+ * Fixed-Size, Type-Erased Callable (a function pointer or a lambda, with or
+ * without captures) which Stores its Target Inline, so Wrapping a Capturing
+ * Lambda Never Touches the Heap. Calling it costs one indirect call, same as a
+ * plain function pointer. Captures must fit in SCHEDULE_CALLABLE_SIZE bytes
+ * (checked at compile time).
+ */
+template <typename Signature>
+class InlineFunction;
 
-typedef bool** ActionState;
-#define new_ActionState(b) new bool*(new bool(b));
+template <typename R, typename... Args>
+class InlineFunction<R(Args...)>{
+public:
+    InlineFunction() : invoker{nullptr}, manager{nullptr} {};
+
+    template <typename F>
+    InlineFunction(F f) : invoker{&invoke<F>}, manager{&manage<F>} {
+        static_assert(sizeof(F) <= SCHEDULE_CALLABLE_SIZE, "Captured state is too big for an InlineFunction (see SCHEDULE_CALLABLE_SIZE).");
+        static_assert(alignof(F) <= alignof(Storage), "Captured state is over-aligned for an InlineFunction.");
+        new (&(this->storage)) F(f);
+    } // ctor
+
+    InlineFunction(const InlineFunction& other) : invoker{other.invoker}, manager{other.manager} {
+        if(this->manager){ this->manager(&(this->storage), &(other.storage)); }
+    } // copy ctor
+
+    InlineFunction& operator=(const InlineFunction& other){
+        if(this != &other){
+            this->clear();
+            this->invoker = other.invoker;
+            this->manager = other.manager;
+            if(this->manager){ this->manager(&(this->storage), &(other.storage)); }
+        }
+        return *this;
+    } // #operator=
+
+    ~InlineFunction(){
+        this->clear();
+    } // dtor
+
+    R operator()(Args... args) const{
+        return this->invoker(&(this->storage), args...);
+    } // #operator()
+
+    explicit operator bool() const{ return this->invoker != nullptr; }
+
+private:
+    union Storage{
+        void* p;
+        long l;
+        double d;
+        unsigned char bytes[SCHEDULE_CALLABLE_SIZE];
+    };
+    mutable Storage storage; // Mutable so lambdas marked "mutable" can be called
+
+    R (*invoker)(void*, Args...);
+    // Copies the Target in %src% into %dst% or, if %src% is null, Destroys %dst%:
+    void (*manager)(void* dst, const void* src);
+
+    template <typename F>
+    static R invoke(void* target, Args... args){
+        return (*static_cast<F*>(target))(args...);
+    } // #invoke
+
+    template <typename F>
+    static void manage(void* dst, const void* src){
+        if(src){
+            new (dst) F(*static_cast<const F*>(src));
+        } else{
+            static_cast<F*>(dst)->~F();
+        }
+    } // #manage
+
+    void clear(){
+        if(this->manager){ this->manager(&(this->storage), nullptr); }
+        this->invoker = nullptr;
+        this->manager = nullptr;
+    } // #clear
+}; // class InlineFunction
+
+/*
+ * Handle to a Boolean State (most often the %done% state of an Action) which is
+ * Stored in a Fixed Pool of Slots. Handles are just a slot index and the
+ * generation of that slot, so they can be copied freely and outlive the
+ * Action which made them: once a slot's owner has released it and it is done,
+ * the slot is recycled under a new generation and any old handles to it read
+ * as done (generations are 16 bits, so a handle would only be mistaken for a
+ * new state after its slot had been reused 65536 times).
+ * A state can also follow another state (see #follow), in which case it reads
+ * as done once the state it follows is done (used by DO_LONG).
+ * Functions can be chained onto a state with #then (and states combined with
+ * when_all / when_any): they're run the moment it becomes done, so nothing
+ * has to poll it. Continuations live in a fixed pool too
+ * (SCHEDULE_CONTINUATIONS).
+ */
+class ActionState{
+public:
+    static const unsigned char NONE = 0xFF; // Index of a Null State (never done)
+    static const unsigned char FINISHED = 0xFE; // Index of a State which is Always Done
+
+    unsigned char index;
+    uint16_t generation;
+
+    ActionState() : index{NONE}, generation{0} {};
+
+    /* Takes a Slot from the Pool for a New State with the Given Value. The
+     caller holds the slot until it calls #release. Returns a null state (and
+     counts an overflow) if the pool is exhausted. */
+    static ActionState make(bool b){
+        Pool& p = pool();
+        unsigned char i;
+        if(p.n_free > 0){
+            i = p.free_slots[--p.n_free];
+        } else if(p.n_touched < SCHEDULE_ACTION_STATES){
+            i = p.n_touched++;
+        } else if(!p.sweep(i)){
+            p.overflows++;
+            return ActionState();
+        }
+        Slot& s = p.slots[i];
+        s.flags = USED | HELD | (b ? DONE : 0);
+        s.link = NONE;
+        s.waiters = 0;
+        return ActionState(i, s.generation);
+    } // #make
+
+    /* Returns a State which is Already Done without Taking a Slot. */
+    static ActionState finished(){
+        return ActionState(FINISHED, 0);
+    } // #finished
+
+    /* Returns Whether this State is Done (true). */
+    bool get() const{
+        if(this->index == FINISHED){ return true; }
+        if(this->index == NONE){ return false; }
+        Slot& s = pool().slots[this->index];
+        if(s.generation != this->generation){ return true; } // Slot was recycled, so it was done
+        if(s.flags & DONE){ return true; }
+        if(s.link != NONE && ActionState(s.link, s.link_generation).get()){
+            // Collapse the Link now that what it Points to is Done:
+            s.flags |= DONE;
+            s.link = NONE;
+            return true;
+        }
+        return false;
+    } // #get
+
+    /* Sets the Value of this State (and stops following any other state).
+     Runs anything waiting on it if it just became done. */
+    void set(bool b){
+        Slot* s = this->slot();
+        if(s){
+            bool was_done = this->get();
+            s->flags = b ? (s->flags | DONE) : (s->flags & ~DONE);
+            s->link = NONE;
+            if(b && !was_done){
+                fire(this->index);
+            }
+        }
+    } // #set
+
+    /* Makes this State Read as Done Once the Given State is Done. */
+    void follow(ActionState other){
+        Slot* s = this->slot();
+        if(s){
+            if(other.get()){
+                this->set(true);
+                return;
+            }
+            s->flags &= ~DONE;
+            s->link = other.index;
+            s->link_generation = other.generation;
+        }
+    } // #follow
+
+    /*
+     * Runs %f% as soon as this State is Done (right away if it already is),
+     * straight from whatever finishes it, so there's no event polling it.
+     * Returns a State which is done once %f% has run (so calls can be
+     * chained). If every continuation slot is taken, %f% is dropped and a null
+     * state is returned (counted in #continuationOverflows).
+     */
+    ActionState then(const InlineFunction<void()>& f){
+        if(this->get()){
+            f();
+            return finished();
+        }
+        ActionState result = make(false);
+        if(!this->wait(f, result)){
+            result.abandon(); // Back to the Pool, since nothing will Finish it
+            return ActionState();
+        }
+        result.release(); // Recycled once done (handles to it still read as done)
+        return result;
+    } // #then
+
+    /* Gives Up the Slot Held by this State. The slot is recycled as soon as
+     it's done (right away if it already is). */
+    void release(){
+        Slot* s = this->slot();
+        if(s){
+            s->flags &= ~HELD;
+            if(this->get()){ pool().recycle(this->index); }
+        }
+    } // #release
+
+    /* Gives Up the Slot of a State whose Owner is Going Away (an Action or
+     Task being deleted, say because its Event was cancelled). Unless it's
+     following another state, nothing can finish it any more, so it's
+     finished now: anything waiting on it runs, and old handles to it read as
+     done once the slot is recycled (which is right away). */
+    void abandon(){
+        Slot* s = this->slot();
+        if(s){
+            if(!(s->flags & DONE) && s->link == NONE){
+                this->set(true);
+            }
+            this->release();
+        }
+    } // #abandon
+
+    // Returns the Number of Times the Pool has Run Out of Slots.
+    static unsigned int overflows(){ return pool().overflows; }
+    // Returns the Number of Times #then has Run Out of Continuations.
+    static unsigned int continuationOverflows(){ return continuations().overflows; }
+
+    /* Has %f% Run (and then %result% Set) once this State is Done (right
+     away if it already is). Returns false if it never will be (null state or
+     no continuation slots left). */
+    bool wait(const InlineFunction<void()>& f, ActionState result = ActionState()){
+        if(this->get()){ // Continuations only Fire when a State Becomes Done
+            f();
+            result.set(true);
+            return true;
+        }
+        Slot* s = this->slot();
+        if(!s){
+            return false; // Null States are Never Done
+        }
+        Continuations& c = continuations();
+        unsigned char n;
+        if(c.n_free > 0){
+            n = c.free_nodes[--c.n_free];
+        } else if(c.n_touched < SCHEDULE_CONTINUATIONS){
+            n = c.n_touched++;
+        } else{
+            c.overflows++;
+            return false;
+        }
+        Continuation& k = c.nodes[n];
+        k.function = f;
+        k.result = result.index;
+        k.result_generation = result.generation;
+        k.next = 0;
+        // Append, so Continuations Run in the Order they were Added:
+        unsigned char* tail = &(s->waiters);
+        while(*tail){
+            tail = &(c.nodes[*tail - 1].next);
+        }
+        *tail = n + 1;
+        return true;
+    } // #wait
+
+protected:
+    static const unsigned char USED = 1; // Slot is Allocated
+    static const unsigned char HELD = 2; // Slot's Owner Hasn't Released It
+    static const unsigned char DONE = 4; // Value of the State
+
+    struct Slot{
+        uint16_t generation;
+        unsigned char flags;
+        unsigned char link; // Index of the State this One Follows (or NONE)
+        uint16_t link_generation;
+        unsigned char waiters; // 1 + Index of the First Continuation Waiting on this State (0 if none)
+    };
+
+    // Function Waiting on a State (and the State to Set once it has Run):
+    struct Continuation{
+        InlineFunction<void()> function;
+        unsigned char result; // State to Set (index and generation)
+        uint16_t result_generation;
+        unsigned char next; // 1 + Index of the Next Continuation on the Same State (0 if none)
+    };
+    struct Continuations{
+        Continuation nodes[SCHEDULE_CONTINUATIONS];
+        unsigned char free_nodes[SCHEDULE_CONTINUATIONS]; // Stack of Freed Nodes
+        unsigned char n_free = 0;
+        unsigned char n_touched = 0; // Number of Nodes ever Handed Out
+        unsigned int overflows = 0;
+    };
+
+    // Pool of Slots. Zero-initialized, so it needs no constructor.
+    struct Pool{
+        Slot slots[SCHEDULE_ACTION_STATES];
+        unsigned char free_slots[SCHEDULE_ACTION_STATES]; // Stack of Recycled Slots
+        unsigned char n_free;
+        unsigned char n_touched; // Number of Slots ever Handed Out (high-water mark)
+        unsigned int overflows;
+
+        void recycle(unsigned char i){
+            this->slots[i].generation++;
+            this->slots[i].flags = 0;
+            this->free_slots[this->n_free++] = i;
+        } // #recycle
+
+        /* Finds a Released Slot whose Link has since Finished and Frees it
+         into %i%. Returns Whether one was Found. */
+        bool sweep(unsigned char& i){
+            for(i = 0; i < SCHEDULE_ACTION_STATES; i++){
+                Slot& s = this->slots[i];
+                if((s.flags & USED) && !(s.flags & HELD) && ActionState(i, s.generation).get()){
+                    s.generation++;
+                    return true;
+                }
+            }
+            return false;
+        } // #sweep
+    };
+
+    static Pool& pool(){
+        static SCHEDULE_THREAD_LOCAL Pool p;
+        return p;
+    } // #pool
+
+    static Continuations& continuations(){
+        static SCHEDULE_THREAD_LOCAL Continuations c;
+        return c;
+    } // #continuations
+
+    /* Runs (and Frees) every Continuation Waiting on Slot %i%, which has just
+     Become Done, after Finishing every State which Follows it. */
+    static void fire(unsigned char i){
+        Pool& p = pool();
+        const uint16_t generation = p.slots[i].generation;
+        for(unsigned char j = 0; j < p.n_touched; j++){
+            Slot& f = p.slots[j];
+            if((f.flags & USED) && !(f.flags & DONE) && f.link == i && f.link_generation == generation){
+                f.flags |= DONE;
+                f.link = NONE;
+                fire(j);
+            }
+        }
+
+        Continuations& c = continuations();
+        unsigned char w = p.slots[i].waiters;
+        p.slots[i].waiters = 0; // Detached, since running them can recycle the slot
+        while(w){
+            Continuation& k = c.nodes[w - 1];
+            InlineFunction<void()> f = k.function;
+            ActionState result(k.result, k.result_generation);
+            k.function = InlineFunction<void()>();
+            c.free_nodes[c.n_free++] = w - 1;
+            w = k.next;
+            f();
+            result.set(true);
+        }
+    } // #fire
+
+    ActionState(unsigned char i, uint16_t g) : index{i}, generation{g} {};
+
+    /* Returns the Slot this Handle Refers to if it's Still Current. */
+    Slot* slot() const{
+        if(this->index >= SCHEDULE_ACTION_STATES){ return nullptr; }
+        Slot& s = pool().slots[this->index];
+        return (s.generation == this->generation && (s.flags & USED)) ? &s : nullptr;
+    } // #slot
+}; // class ActionState
+#define new_ActionState(b) ActionState::make(b)
+
+/* Returns a State which is Done once Every Given State is Done (without
+ polling any of them). Returns a null state if that can't be waited for (one
+ of them is null, or there are no continuation slots left). */
+inline ActionState when_all(ActionState a){
+    return a;
+} // #when_all
+template <typename... Rest>
+ActionState when_all(ActionState a, ActionState b, Rest... rest){
+    ActionState both = ActionState::make(false);
+    if(!a.wait([b, both]() mutable { both.follow(b); })){ // Once %a% is done, wait on %b%
+        both.abandon();
+        return ActionState();
+    }
+    both.release();
+    return when_all(both, rest...);
+} // #when_all
+
+// Has Each of the Given States Finish %any% (helper of #when_any). Returns
+// the Number of them which can:
+inline unsigned int when_any_into(ActionState){ return 0; }
+template <typename... Rest>
+unsigned int when_any_into(ActionState any, ActionState a, Rest... rest){
+    unsigned int waiting = a.wait([any]() mutable { any.set(true); }) ? 1 : 0;
+    return waiting + when_any_into(any, rest...);
+} // #when_any_into
+/* Returns a State which is Done as soon as Any of the Given States is Done
+ (without polling any of them). Returns a null state if none of them can be
+ waited for. */
+template <typename... States>
+ActionState when_any(States... states){
+    ActionState any = ActionState::make(false);
+    if(!when_any_into(any, states...)){
+        any.abandon();
+        return ActionState();
+    }
+    any.release();
+    return any;
+} // #when_any
 
 /*
  * Container for Action which are called in events and their respective metadata.
  */
 class Action{ // Abstract Container for Use in Arrays of Pointers
 public:
-    bool* done = new bool(false);
+    ActionState done = ActionState::make(false);
 
     virtual ~Action(){
-        //delete done; // <- Leave the done state variable behind
-        //done = nullptr;
+        this->done.abandon(); // Slot is recycled once anything this Action follows is done
     } // dtor
 
     virtual void call() = 0;
 
     /* Tells Whether this Action and its Required Actions are Complete. Returns
-     the dereferrenced state of member %done% */
+     the state of member %done% */
     bool isDone(){
-        return *(this->done);
+        return this->done.get();
     } // #isDone
 }; // class Action
 /*
@@ -112,14 +872,14 @@ public:
  */
 class BasicAction : public Action{
 public:
-    // Type of Function to be Called which Consumes the Stored Data:
-    typedef void (*function) ();
+    // Type of Function to be Called (function pointer or lambda):
+    typedef InlineFunction<void()> function;
 
     BasicAction(function f) : oncall{f} {};
 
     void call(){
         oncall();
-        *(this->done) = true;
+        this->done.set(true);
     }
 private:
     // Function to be Executed when this Action is Called:
@@ -132,8 +892,8 @@ private:
  */
 class NestingAction : public Action{
 public:
-    // Type of Function to be Called which Consumes the Stored Data:
-    typedef void (*function) (Action*);
+    // Type of Function to be Called (function pointer or lambda):
+    typedef InlineFunction<void(Action*)> function;
 
     NestingAction(function f) : oncall{f} {};
 
@@ -163,7 +923,7 @@ public:
     // Calls this Action by Passing the Stored Data to #oncall and Calling It.
     void call(){
         oncall(data);
-        *(this->done) = true;
+        this->done.set(true);
     }
 private:
     // Function to be Executed when this Action is Called:
@@ -195,34 +955,259 @@ private:
     function oncall;
 }; // Class: NestingDataAction
 
+#if defined(_CFCT_) && defined(SCHEDULE_THREADS)
+/*
+ * Work-Stealing Pool of Threads which Run Jobs Handed to it by a Schedule.
+ * Every worker has its own queue: jobs are dealt out to them in turn, each
+ * worker takes the newest job from its own queue and, once that's empty,
+ * steals the oldest job from any other. #wait is the barrier at the end of a
+ * pass (the calling thread helps run jobs until they're all done).
+ */
+class WorkPool{
+public:
+    typedef InlineFunction<void()> Job;
+
+    WorkPool(unsigned int n_threads) : queues(n_threads > 0 ? n_threads : 1) {
+        for(unsigned int i = 0; i != this->queues.size(); i++){
+            this->threads.push_back(std::thread([this, i](){ this->work(i); }));
+        }
+    } // ctor
+
+    ~WorkPool(){
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+        this->work_ready.notify_all();
+        for(std::vector<std::thread>::size_type i = 0; i != this->threads.size(); i++){
+            this->threads[i].join();
+        }
+    } // dtor
+
+    /* Returns the Number of Worker Threads. */
+    unsigned int size() const{
+        return this->queues.size();
+    } // #size
+
+    /* Queues the Given Job to be Run by a Worker. */
+    void submit(const Job& job){
+        Queue& q = this->queues[this->next_queue];
+        this->next_queue = (this->next_queue + 1) % this->queues.size();
+        this->pending++;
+        {
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.jobs.push_back(job);
+        }
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->queued++;
+        }
+        this->work_ready.notify_one();
+    } // #submit
+
+    /* Runs Jobs on the Calling Thread until Every Submitted Job is Done. */
+    void wait(){
+        Job job;
+        while(this->pending > 0){
+            if(this->take(0, job)){
+                this->run(job);
+            } else{
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->all_done.wait(lock, [this](){ return this->pending == 0; });
+            }
+        }
+    } // #wait
+
+protected:
+    struct Queue{
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+    std::vector<Queue> queues; // One per Worker
+    std::vector<std::thread> threads;
+    std::vector<Queue>::size_type next_queue = 0; // Queue the Next Job is Dealt to
+    std::mutex mutex; // Guards %queued% and %stopping% (for the condition variables)
+    std::condition_variable work_ready; // Notified when a Job is Queued (or on Stopping)
+    std::condition_variable all_done; // Notified when the Last Pending Job Finishes
+    unsigned long queued = 0; // Jobs in all the Queues
+    std::atomic<unsigned long> pending{0}; // Jobs Queued or Running
+    bool stopping = false;
+
+    /* Takes a Job from Queue %i% (newest first) or Steals one from Another
+     (oldest first). Returns Whether there was One. */
+    bool take(std::vector<Queue>::size_type i, Job& job){
+        for(std::vector<Queue>::size_type n = 0; n != this->queues.size(); n++){
+            Queue& q = this->queues[(i + n) % this->queues.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if(!q.jobs.empty()){
+                if(n == 0){
+                    job = q.jobs.back();
+                    q.jobs.pop_back();
+                } else{
+                    job = q.jobs.front();
+                    q.jobs.pop_front();
+                }
+                std::lock_guard<std::mutex> count_lock(this->mutex);
+                this->queued--;
+                return true;
+            }
+        }
+        return false;
+    } // #take
+
+    /* Runs the Given Job and Counts it as Done. */
+    void run(const Job& job){
+        job();
+        if(--this->pending == 0){
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->all_done.notify_all();
+        }
+    } // #run
+
+    /* Body of Worker Thread %i%. */
+    void work(std::vector<Queue>::size_type i){
+        Job job;
+        while(true){
+            if(this->take(i, job)){
+                this->run(job);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->work_ready.wait(lock, [this](){ return this->stopping || this->queued > 0; });
+            if(this->stopping && this->queued == 0){
+                return;
+            }
+        }
+    } // #work
+}; // Class: WorkPool
+#endif
+
+class Schedule;
+class Source;
+template <typename T> class Signal;
+
+/*
+ * Running Instance of a Resumable (protothread-style) Function. Each time it's
+ * resumed, its body is called again and jumps straight to the point it last
+ * yielded from (see TASK_BEGIN, WAIT, etc.), so long behaviors can wait without
+ * blocking every other event on the Schedule.
+ * NOTE: Since the body returns at every wait, its local variables don't
+ * survive one (and can't be declared between waits). Keep anything which must
+ * in the lambda's captures instead (made "mutable").
+ */
+class Task{
+public:
+    // Type of Function which forms the Body of the Task:
+    typedef InlineFunction<void(Task*)> function;
+
+    unsigned short line = 0; // Where in the Body to Resume from (0 is the start)
+    bool finished = false; // Whether the Body has Reached TASK_END
+    bool polling = false; // Whether it's Waiting on a Condition (checked every pass) rather than a Time
+    schedule_time_t wake = 0; // Time after which it Resumes (unless %polling%)
+    ActionState pending; // State Awaited by AWAIT
+    ActionState done = ActionState::make(false); // Set once the Task Finishes
+
+    Task(function f) : body{f} {};
+
+    ~Task(){
+        this->done.abandon();
+    } // dtor
+
+    /* Runs the Body up to its Next Wait (or its end). */
+    void resume(){
+        this->body(this);
+    } // #resume
+
+    /* Returns Whether the Task should be Resumed at Time %now%. */
+    bool isDue(schedule_time_t now) const{
+        return this->polling || timePassed(now, this->wake);
+    } // #isDue
+
+    /* Waits for %t% Ticks. */
+    void sleepFor(schedule_time_t t){
+        this->wake = scheduleNow() + t;
+        this->polling = false;
+    } // #sleepFor
+
+    /* Waits on a Condition. */
+    void poll(){
+        this->polling = true;
+    } // #poll
+
+    /* Marks the Task as Done. */
+    void finish(){
+        this->finished = true;
+        this->done.set(true);
+    } // #finish
+
+private:
+    function body;
+}; // class Task
+
+/*
+ * Action which Spawns a Task on the Schedule each Time it's Called (unless the
+ * last one is still running) and is done once that Task Finishes.
+ */
+class ResumableAction : public Action{
+public:
+    ResumableAction(Schedule* s, Task::function f) : schedule{s}, oncall{f} {};
+
+    void call();
+private:
+    Schedule* schedule;
+    // Body of the Task to be Spawned when this Action is Called:
+    Task::function oncall;
+    ActionState running = ActionState::finished(); // Done State of the Last Task Spawned
+}; // class ResumableAction
+
 /*
  * Basic Event Class which Triggers only when Called Directly.
  */
 class Event{
 public:
-    // Basic void-void function which can signup for the event:
-    typedef void (*RegisteredFunction) ();
+    // Basic void-void function (or lambda) which can signup for the event:
+    typedef InlineFunction<void()> RegisteredFunction;
     const bool runs_once; // Indentifies whether this event only happens once.
 
+    // Priority Classes:
+    enum Priority{
+        NORMAL = 0, // Checked once per pass, in turn
+        CRITICAL = 1 // Checked between every NORMAL event which runs
+    };
+    unsigned char priority = NORMAL;
+
+    // Lifecycle Flags (see #cancel, #pause and #resume):
+    static const unsigned char PAUSED = 1; // Shouldn't Trigger until Resumed
+    static const unsigned char CANCELLED = 2; // Tombstone: Freed when its Schedule Next Comes Across It
+    static const unsigned char PARKED = 4; // Paused and Dropped from its Schedule's Lists
+    static const unsigned char PARKED_TIMER = 8; // Dropped from the Timer Heap (rather than a list)
+    static const unsigned char TIMED = 16; // Is a TimedEvent
+    static const unsigned char READY = 32; // A NOW Event: Waits in the Ready Queue rather than the Timer Heap
+    static const unsigned char REACTIVE = 64; // A Reactive ConditionalEvent: Listed by the Sources it Reads, not Polled
+    static const unsigned char UNLISTED = 128; // In None of its Schedule's Lists (see Schedule#onTrigger)
+    unsigned char status = 0;
+
+#ifdef SCHEDULE_PROFILE
+    EventProfile profile; // Statistics about this Event's Runs
+    const char* name = nullptr; // Label for this Event in Schedule::dumpProfile
+    unsigned int profile_index = 0; // Position in its Schedule's %profiled% (lasting events only)
+#endif
+#ifdef SCHEDULE_THREADS
+    bool is_independent = false; // Whether its Functions can Run on the Schedule's Workers
+#endif
+
     Event() : runs_once{false} {};
 
     virtual ~Event(){
-        /*for(
-            std::vector<Action*>::iterator it = this->registry.begin();
-            it != this->registry.end();
-            ++it
-            ){
-            delete (*it);
-        }
-         this->registry.clear(); // TODO: Need to come up with way to make Action::done itself stick around*/
+        this->clearRegistry();
     } // dtor
 
     /*
-     * Request this Event to Execute ASAP.
+     * Request this Event to Execute ASAP. Events which none of the Schedule's
+     * lists poll (those made by Schedule#onTrigger) are put in its ready
+     * queue, so a call from an action runs later in the same pass.
      * NOTE: Calls happen IN ADDITION to any event-specific timings or conditions. */
-    void call(){
-        this->calledButNotRun = true;
-    } // #call
+    virtual void call();
 
     /*
      * Executes this Event if it Should Execute either Because it's been Called or
@@ -239,61 +1224,294 @@ public:
         return 0;
     } // #tryExecute
 
+    /*
+     * Makes this Event CRITICAL: rather than waiting its turn in a pass, it's
+     * checked (and run if it should be) between every NORMAL event that runs,
+     * so slow actions elsewhere don't delay it by more than one action each.
+     * (Reactive events can't be critical.) Returns this Event.
+     */
+    Event* critical();
+
     /* Test if this Event Should Self-Trigger*/
     virtual bool shouldTrigger(){
         return 0; // Basic Events only Trigger when Explicitly Called
     } // #shouldTrigger
 
-    /* Add the Given Function to the %registry% as a BasicAction to be Executed
-     Every Time the Event is Triggered. Returns a double pointer of the done variable of the Action created. */
-    bool** signup(RegisteredFunction fcn){
-        Action* a = new BasicAction(fcn);
-        this->registry.push_back(a);
-        return &(a->done);
+    /*
+     * What Signing Up a Function Returns: stands in for its done state (done
+     * once it has run), which only takes a slot from the ActionState pool if
+     * it's asked for (by turning this into an ActionState, or calling #get or
+     * #then) before the function first runs, so the many do_s whose states
+     * are never looked at don't use up the pool. Turn it into an ActionState
+     * right away rather than keeping it (it points into its Event).
+     */
+    class Registration{
+    public:
+        Registration(Event* e, unsigned int n) : event{e}, entry{n} {};
+
+        /* Returns the Done State of the Function (taking a slot for it if
+         it hasn't run yet). */
+        ActionState state() const{
+            return this->event->stateOf(this->entry);
+        } // #state
+        operator ActionState() const{ return this->state(); }
+
+        /* Returns Whether the Function has Run. */
+        bool get() const{ return this->state().get(); }
+
+        /* Runs %f% once the Function has Run (see ActionState#then). */
+        ActionState then(const InlineFunction<void()>& f) const{
+            return this->state().then(f);
+        } // #then
+
+    private:
+        Event* event;
+        unsigned int entry; // Index of its Entry in registry + signed_late
+    }; // class Registration
+
+    /* Add the Given Function to the %registry% to be Executed Every Time the
+     Event is Triggered (stored in place, not as a separate Action). Returns its
+     done state (done once it has run), see Registration. */
+    Registration signup(RegisteredFunction fcn){
+        Registered r;
+        r.function = fcn;
+        r.action = nullptr;
+        Registration handle(this, (unsigned int)(this->registry.size() + this->signed_late.size()));
+        this->enlist(r);
+        return handle;
     } // #signup
 
     /* Add the Given Action to the %registry% to be Executed Every Time the Event
-     is Triggered. Returns a double pointer of the done variable of the Action. */
-    bool** signup(Action* a){
-        this->registry.push_back(a);
-        return &(a->done);
+     is Triggered. Returns the done state of the Action. */
+    ActionState signup(Action* a){
+        Registered r;
+        r.action = a;
+        this->enlist(r);
+        return a->done;
     } // #signup
 
     // Alias for Signing Up for the Event
-    bool** do_(RegisteredFunction fcn){ return signup(fcn); }
-    bool** do_(Action* a){ return signup(a); }
+    Registration do_(RegisteredFunction fcn){ return signup(fcn); }
+    ActionState do_(Action* a){ return signup(a); }
+
+    /* Signs Up a Task Body (see Task) to be Run as a ResumableAction Every
+     Time the Event is Triggered. Returns the done state of the Action. */
+    ActionState resumable(Task::function f){
+        return signup(new ResumableAction(this->schedule, f));
+    } // #resumable
 
     // Calls All Functions Registered to this Event
     void execute(){
         if(!this->ran || !this->runs_once){
+#ifdef SCHEDULE_PROFILE
+            unsigned long start = profileNow();
+#endif
             // Do this ^ check instead of deleting self b/c pointer might be accessed later if in list.
-            for(std::vector<Action*>::size_type i = 0; i != this->registry.size(); i++) {
-                this->registry[i]->call();
+#ifdef SCHEDULE_THREADS
+            if(this->awaiting_workers){ // Ran Already this Pass: don't Call a Function on Two Workers at Once
+                this->awaitWorkers();
+            }
+#endif
+            this->executing = true;
+            for(std::vector<Registered>::size_type i = 0; i != this->registry.size(); i++) {
+                Registered& r = this->registry[i];
+                if(r.action){
+                    r.action->call();
+#ifdef SCHEDULE_THREADS
+                } else if(this->is_independent){
+                    this->dispatch(r);
+#endif
+                } else{
+                    r.function();
+                    r.finish();
+                }
             }
+            this->executing = false;
+#ifdef SCHEDULE_THREADS
+            if(!this->awaiting_workers) // Otherwise Settled once the Workers are Done with its Entries
+#endif
+            this->settle();
             this->ran = true;
+#ifdef SCHEDULE_PROFILE
+            this->profile.ran(profileNow() - start);
+#endif
         }
     } // #execute
 
+    /* Returns Whether this Event is neither Paused nor Cancelled. */
+    bool isActive() const{
+        return !(this->status & (PAUSED | CANCELLED));
+    } // #isActive
+
+    /*
+     * Stops this Event for Good. Its Schedule frees it (and its Actions) as
+     * soon as it next comes across it (right away if it's paused or was made
+     * by Schedule#onTrigger), so the pointer mustn't be used after this.
+     * Reactive events are unsubscribed from every Signal and State they read
+     * straight away and freed in the next pass. The done states of
+     * any of its Actions which hadn't finished then read as done, so nothing
+     * waits on them forever (anything chained on with ActionState#then runs).
+     */
+    void cancel();
+
+    /* Stops this Event from Triggering until #resume is Called. Its Schedule
+     drops it from the lists it checks, so it costs nothing while paused. */
+    void pause(){
+        this->status |= PAUSED;
+    } // #pause
+
+    /* Lets a Paused Event Trigger Again (timed events count their interval
+     from now). */
+    virtual void resume();
+
+    /* Labels this Event in the Table Printed by Schedule::dumpProfile (does
+     nothing unless SCHEDULE_PROFILE is defined). Returns this Event. */
+    Event* named(const char* n){
+#ifdef SCHEDULE_PROFILE
+        this->name = n;
+#else
+        (void) n;
+#endif
+        return this;
+    } // #named
+
+    /*
+     * Declares that the Functions Signed Up to this Event (not any Actions
+     * which make other events, like DO_LONG) don't touch anything but their
+     * own state, so with SCHEDULE_THREADS and Schedule#useThreads they're run
+     * on worker threads while the pass carries on. Every one of them finishes
+     * (and is marked done) before the pass that triggered it ends. They're
+     * called in place, so what they keep in their captures lasts from run to
+     * run (and one never runs on two workers at once). Does nothing
+     * otherwise. Returns this Event.
+     * NOTE: Workers have their own VirtualClock (and ActionState pool), so
+     * with SCHEDULE_VIRTUAL_CLOCK these functions mustn't read the time.
+     */
+    Event* independent(){
+#ifdef SCHEDULE_THREADS
+        this->is_independent = true;
+#endif
+        return this;
+    } // #independent
+
+    // Which of its Schedule's Polled Lists this Event Lives in (if any):
+    enum Bucket{
+        UNPOLLED = 0,
+        WHILE_BUCKET = 1,
+        WHEN_BUCKET = 2,
+        EVERY_WHILE_BUCKET = 3
+    };
+    unsigned char bucket = UNPOLLED;
+
 protected:
+    friend class Schedule;
     Event(bool ro) : runs_once{ro} {};
-    std::vector<Action*> registry;
+    Schedule* schedule = nullptr; // Schedule this Event Belongs to (if any)
+
+    // Entry in the %registry%: a plain function (called in place, with its own
+    // done state, which is null until it's asked for or the function runs) or,
+    // if %action% is set, an Action to call:
+    struct Registered{
+        RegisteredFunction function;
+        Action* action;
+        ActionState done;
+
+        /* Marks the Function as having Run. */
+        void finish(){
+            if(this->done.index == ActionState::NONE){
+                this->done = ActionState::finished(); // Never Asked for, so No Slot Needed
+            } else{
+                this->done.set(true); // Slot is Recycled (it was released when it was made)
+            }
+        } // #finish
+    };
+    std::vector<Registered> registry;
+    // Entries Signed Up while the Event was Executing (would move the ones
+    // being called), added to the %registry% once it's done:
+    std::vector<Registered> signed_late;
+    bool executing = false; // Whether #execute is Running
+
+    /* Ends a Run: adds anything Signed Up during it to the %registry%. */
+    void settle(){
+        if(!this->signed_late.empty()){ // Signed up while Running, so Join in Now
+            this->registry.insert(this->registry.end(), this->signed_late.begin(), this->signed_late.end());
+            this->signed_late.clear();
+        }
+    } // #settle
+
+#ifdef SCHEDULE_THREADS
+    // Whether Workers may still be Calling its Functions (in place, so its
+    // %registry% mustn't move until the Schedule settles it):
+    bool awaiting_workers = false;
+    void dispatch(Registered& r);
+    void awaitWorkers();
+#endif
+
+    /* Returns the Done State of the %n%th Function Signed Up (see
+     Registration), making it if it's Needed. */
+    ActionState stateOf(unsigned int n){
+        Registered* r;
+        if(n < this->registry.size()){
+            r = &(this->registry[n]);
+        } else if(n - this->registry.size() < this->signed_late.size()){
+            r = &(this->signed_late[n - this->registry.size()]);
+        } else{
+            return ActionState::finished(); // Registry was Cleared (Event is Done)
+        }
+        if(r->action){ return r->action->done; }
+        if(r->done.index == ActionState::NONE){
+            r->done = ActionState::make(false);
+            r->done.release(); // Recycled once the function has run
+        }
+        return r->done;
+    } // #stateOf
+
+    /* Adds the Given Entry to the %registry% (or to %signed_late%). */
+    void enlist(const Registered& r){
+#ifdef SCHEDULE_THREADS
+        if(this->executing || this->awaiting_workers){
+#else
+        if(this->executing){
+#endif
+            this->signed_late.push_back(r);
+        } else{
+            this->registry.push_back(r);
+        }
+    } // #enlist
+
+    /* Deletes all Registered Actions and Gives Up the Done States of the
+     Functions (any which never ran are abandoned, see ActionState#abandon). */
+    void clearRegistry(){
+        this->registry.insert(this->registry.end(), this->signed_late.begin(), this->signed_late.end());
+        this->signed_late.clear();
+        for(std::vector<Registered>::size_type i = 0; i != this->registry.size(); i++){
+            if(this->registry[i].action){
+                delete this->registry[i].action;
+            } else{
+                this->registry[i].done.abandon();
+            }
+        }
+        this->registry.clear();
+    } // #clearRegistry
+
     bool ran = false; // Whether this function has been run before (ever).
     bool calledButNotRun = false; // Whether this Event has been Called Recently but Not Yet Executed
+    bool in_ready = false; // Whether it's in its Schedule's Ready Queue (at most once)
+    unsigned int owned_index = 0; // Position in its Schedule's %owned% (unless it's a pooled one-shot)
+
+    /* Has this Event Run from its Schedule's Ready Queue. */
+    void queueCall();
 }; // Class: Event
 
 /* Event which Triggers Anytime #shouldTrigger is called and its condition is True*/
 class ConditionalEvent : public Event{
 public:
-    typedef bool (*EventCondition) ();
+    typedef InlineFunction<bool()> EventCondition;
 
     EventCondition condition; // Function that Triggers the Event if it's Ready to be Triggered
 
     ConditionalEvent(EventCondition t) : condition{t} {}; // Constructor
 
-    virtual ~ConditionalEvent(){
-        delete& condition;
-    } // Destructor
-
     /*
      * Triggers this Event if its %condition% Allows It.
      * Returns Whether the Event was Triggered.
@@ -304,6 +1522,41 @@ public:
         }
         return 0;
     } // #shouldTrigger
+
+    /*
+     * Makes this Event Reactive: instead of being polled every pass, its
+     * %condition% is only re-evaluated when a Signal or State it read last
+     * time changes (inputs are tracked automatically as they're read).
+     * Only use this if %condition% reads nothing else that changes (no #millis,
+     * raw sensor reads, plain globals, etc.). Returns this Event.
+     */
+    ConditionalEvent* reactive();
+
+    /* Request this Event to Execute ASAP. */
+    void call();
+
+    /* Lets a Paused Event Trigger Again (reactive ones are re-evaluated). */
+    void resume();
+
+protected:
+    friend class Schedule;
+    friend class Source;
+    bool is_reactive = false; // Whether this Event is Pushed Changes rather than Polled
+    bool queued = false; // Whether this Event is Waiting to be Re-Evaluated
+    bool holding = false; // Whether the Condition was True at the Last Evaluation
+    unsigned int held_index = 0; // Position in Schedule::held while %holding% (WHILE only)
+    std::vector<Source*> inputs; // Sources this (Reactive) Event has Subscribed to
+
+    /* Evaluates %condition%, Recording every Source Read while Doing So as an
+     Input of this Event. */
+    bool evaluate();
+
+    /* Unsubscribes this Event from every Source it Reads (once it's cancelled). */
+    void unsubscribe();
+
+    /* Re-Evaluates a Reactive Event after one of its Inputs Changed. A WHILE
+     keeps running every pass for as long as its condition holds. */
+    virtual void react();
 };
 
 /*
@@ -328,6 +1581,16 @@ public:
 
 protected:
     bool last_state = false;
+
+    /* Re-Evaluates a Reactive Event after one of its Inputs Changed. */
+    void react(){
+        bool curr_state = this->evaluate();
+        if((curr_state && !this->last_state) || this->calledButNotRun){
+            this->execute();
+            this->calledButNotRun = false;
+        }
+        this->last_state = curr_state;
+    } // #react
 };
 
 /*
@@ -336,80 +1599,151 @@ protected:
  */
 class TimedEvent : public Event{
 public:
-    unsigned long interval; // Interval between Executions
-
-    TimedEvent(unsigned long i) : interval{i} {
-        this->timer = i;
-        this->last_time = millis();
+    // Overrun Policies (what to do about deadlines which pass while this Event
+    // is held up, see #onOverrun):
+    static const unsigned char CATCH_UP = 0; // Run once for every deadline, one a pass, until caught up (default)
+    static const unsigned char SKIP_MISSED = 1; // Run once, then skip to the next deadline in phase with the original ones
+    static const unsigned char REALIGN = 2; // Run once, then be due a whole interval from then
+
+    schedule_time_t interval; // Interval between Executions
+    schedule_time_t deadline; // Time after which this Event is Next Due
+    unsigned char overrun_policy = CATCH_UP;
+    unsigned long missed = 0; // Number of Deadlines Missed (already passed when it ran for the one before)
+
+    TimedEvent(schedule_time_t i) : interval{i} {
+        this->deadline = scheduleNow() + i;
+        this->status = TIMED;
     }; // Constructor
 
     ~TimedEvent(){ } // Destructor
 
     /*
-     * Triggers this Event if its %condition% Allows It.
+     * Returns Whether this Event's %deadline% has Passed at Time %now%.
+     * Comparison is done on the signed difference so it stays correct across
+     * the rollover of the clock.
+     */
+    bool isDue(schedule_time_t now) const{
+        return timePassed(now, this->deadline);
+    } // #isDue
+
+    /* Records how Late this Event is Firing at Time %now% (only when
+     SCHEDULE_PROFILE is defined). Call before advancing the %deadline%. */
+    void profileLateness(schedule_time_t now){
+#ifdef SCHEDULE_PROFILE
+        this->profile.late(now - this->deadline - 1); // Due from just after the deadline
+#else
+        (void) now;
+#endif
+    } // #profileLateness
+
+    /*
+     * Sets what this Event does about Deadlines which Pass while it's Held up
+     * (by a long action, a busy pass, etc.): CATCH_UP (run on every pass
+     * until it's caught up, keeping the count of runs), SKIP_MISSED (run
+     * once and carry on in phase) or REALIGN (run once and restart the
+     * interval from then). Either way, the deadlines are counted in %missed%.
+     */
+    TimedEvent* onOverrun(unsigned char policy){
+        this->overrun_policy = policy;
+        return this;
+    } // #onOverrun
+
+    /* Moves the %deadline% on from the One being Run at Time %now%, as the
+     %overrun_policy% says, Counting any Deadlines it had Missed since. */
+    void advance(schedule_time_t now){
+        schedule_time_t behind = this->interval ? (now - this->deadline - 1) / this->interval : 0; // Due from just after the deadline
+        if(this->overrun_policy == CATCH_UP){
+            this->missed += behind > 0; // The rest are counted as it catches up
+            this->deadline += this->interval; // Keeps execution freq. as close to interval as possible
+        } else{
+            this->missed += behind;
+            if(this->overrun_policy == SKIP_MISSED){
+                this->deadline += (behind + 1) * this->interval;
+            } else{
+                this->deadline = now + this->interval;
+            }
+        }
+    } // #advance
+
+    /*
+     * Triggers this Event if its %deadline% has Passed.
      * Returns Whether the Event was Triggered.
      */
     bool shouldTrigger(){
-        unsigned long now = millis();
-        this->timer -= now - last_time;
-        this->last_time = now;
-
-        if(this->timer < 0){
-            this->timer += this->interval; // Keeps execution freq. as close to interval as possible
+        schedule_time_t now = scheduleNow();
+        if(this->isDue(now)){
+            this->profileLateness(now);
+            this->advance(now);
             return 1;
         }
 
         return 0;
     }  // #shouldTrigger
 
+    /* Request this Event to Execute ASAP (lets the owning Schedule know since
+     TimedEvents aren't polled). */
+    void call();
+
 protected:
-    unsigned long last_time;
-    long timer;
-    TimedEvent(bool runs_once_, unsigned long i) : Event(runs_once_), interval{i} {
-        this->timer = i;
-        this->last_time = millis();
+    friend class Schedule;
+
+    TimedEvent(bool runs_once_, schedule_time_t i) : Event(runs_once_), interval{i} {
+        this->deadline = scheduleNow() + i;
+        this->status = TIMED;
     };
 };
 
 /* An Event which Triggers Once After a Set Period of Time */
 class SingleTimedEvent : public TimedEvent{
 public:
-    SingleTimedEvent(unsigned long i) : TimedEvent(true, i) {}; // Constructor
+    SingleTimedEvent(schedule_time_t i) : TimedEvent(true, i) {}; // Constructor
+
+protected:
+    friend class Schedule;
+    SingleTimedEvent() : TimedEvent(true, 0) {}; // Constructor for Pooled Slots
+
+    /* Resets a Pooled Slot so it will Trigger Once in %t% Ticks. */
+    void arm(schedule_time_t t){
+        this->interval = t;
+        this->deadline = scheduleNow() + t;
+        this->ran = false;
+        this->calledButNotRun = false;
+        this->missed = 0;
+        this->status = TIMED;
+        this->clearRegistry(); // Keeps its capacity, so re-registering won't reallocate
+#ifdef SCHEDULE_PROFILE
+        this->profile = EventProfile();
+#endif
+    } // #arm
 };
 
 /* An Event which Triggers at a Certain Frequency so Long as a Given Condition is True */
 class ConditionalTimedEvent : public TimedEvent{
 public:
-    typedef bool (*EventCondition) ();
+    typedef InlineFunction<bool()> EventCondition;
 
     EventCondition condition; // Function that Triggers the Event if it's Ready to be Triggered
 
-    ConditionalTimedEvent(unsigned long i, EventCondition t) : TimedEvent(i), condition(t){};
-
-    virtual ~ConditionalTimedEvent(){
-        delete& condition;
-    } // Destructor
+    ConditionalTimedEvent(schedule_time_t i, EventCondition t) : TimedEvent(i), condition(t){};
 
     /*
      * Triggers this Event if its %condition% Allows It.
      * Returns Whether the Event was Triggered.
      */
     bool shouldTrigger(){
-        unsigned long now = millis();
-        this->timer -= now - last_time;
-        this->last_time = now;
-
+        schedule_time_t now = scheduleNow();
         bool curr_state = this->condition();
 
         // Everytime Condition Becomes True, Restart Timer
         if(curr_state && !this->last_state){
-            timer = this->interval;
+            this->deadline = now + this->interval;
         }
 
         this->last_state = curr_state;
 
-        if(curr_state && this->timer < 0){
-            this->timer += this->interval; // Keeps execution freq. as close to interval as possible
+        if(curr_state && this->isDue(now)){
+            this->profileLateness(now);
+            this->advance(now);
             return 1;
         }
 
@@ -420,67 +1754,1873 @@ protected:
     bool last_state = false;
 };
 
+/*
+ * Event Triggered by Edges on a Digital Pin, Caught by its Interrupt (so
+ * pulses shorter than a pass aren't missed and nothing polls the pin). The
+ * interrupt only stamps the time of the edge into a small ring (see
+ * SCHEDULE_EDGE_QUEUE) and wakes the Schedule; its next #loop runs the Event
+ * once per edge, with %time% and %rising% describing that edge.
+ * Make these with Schedule#onPinEdge. On the host (or for testing anywhere),
+ * edges can be fed in with #inject instead.
+ * NOTE: Only pins with an external interrupt (attachInterrupt) work, eg. 2
+ * and 3 on an Uno; pin-change interrupts (PCINT) aren't supported.
+ */
+class PinEdgeEvent : public Event{
+public:
+    // Edges to Trigger on (can be or'd together):
+    static const unsigned char RISING_EDGE = 1;
+    static const unsigned char FALLING_EDGE = 2;
+    static const unsigned char BOTH_EDGES = RISING_EDGE | FALLING_EDGE;
+
+    const unsigned char pin;
+    const unsigned char edges; // Which Edges Trigger this
+    unsigned long time = 0; // micros() at the Edge being Handled
+    bool rising = false; // Whether the Edge being Handled was Rising
+    volatile unsigned long overflows = 0; // Number of Edges Dropped because the Ring was Full
+
+    PinEdgeEvent(unsigned char p, unsigned char e) : pin{p}, edges{e} {};
+
+    /* Records an Edge at Time %t% (in micros) as if the Pin's Interrupt had
+     Caught it. Safe to call from an interrupt or (one) other thread. */
+    void inject(bool is_rising, unsigned long t);
+
+    /* Request this Event to Execute ASAP (through its Schedule's ready queue,
+     with %time% and %rising% left as the last edge's). */
+    void call(){ this->queueCall(); }
+
+protected:
+    friend class Schedule;
+    struct Edge{
+        unsigned long time;
+        bool rising;
+    };
+    Edge ring[SCHEDULE_EDGE_QUEUE];
+    unsigned char head = 0; // Next Edge to Handle (written by the Schedule)
+    unsigned char tail = 0; // Next Slot to Fill (written by the interrupt)
+    unsigned char isr_slot = 0xFF; // Which Interrupt Trampoline is Attached (if any)
+
+    /* Takes the Oldest Edge into %time% and %rising%. Returns Whether there
+     was One. */
+    bool nextEdge(){
+        unsigned char h = __atomic_load_n(&this->head, __ATOMIC_RELAXED);
+        if(h == __atomic_load_n(&this->tail, __ATOMIC_ACQUIRE)){
+            return false;
+        }
+        this->time = this->ring[h].time;
+        this->rising = this->ring[h].rising;
+        __atomic_store_n(&this->head, (unsigned char)((h + 1) % SCHEDULE_EDGE_QUEUE), __ATOMIC_RELEASE);
+        return true;
+    } // #nextEdge
+
+    /* Returns Whether any Edge is Waiting. */
+    bool edgesPending(){
+        return __atomic_load_n(&this->tail, __ATOMIC_ACQUIRE) != __atomic_load_n(&this->head, __ATOMIC_RELAXED);
+    } // #edgesPending
+
+#ifndef _CFCT_
+    // Events Attached to each Interrupt Trampoline:
+    static PinEdgeEvent** handlers(){
+        static PinEdgeEvent* h[SCHEDULE_PIN_EDGES];
+        return h;
+    } // #handlers
+
+    // Interrupt Service Routine Attached for the Event in Handler Slot %k%:
+    template <unsigned char k>
+    static void isr(){
+        PinEdgeEvent* e = handlers()[k];
+        e->inject(e->edges == BOTH_EDGES ? digitalRead(e->pin) : e->edges == RISING_EDGE, SCHEDULE_EDGE_CLOCK());
+    } // #isr
+
+    // Returns the ISR for Handler Slot %i% (below %n%):
+    template <unsigned char n>
+    struct ISRs{
+        static void (*get(unsigned char i))(){
+            return i == n - 1 ? &isr<n - 1> : ISRs<n - 1>::get(i);
+        }
+    };
+
+    /* Attaches this Event to its Pin's Interrupt. Returns Whether the Pin
+     has an External Interrupt and there was a Free Trampoline (see
+     SCHEDULE_PIN_EDGES) to attach to it. */
+    bool attach(){
+#ifdef NOT_AN_INTERRUPT
+        if(digitalPinToInterrupt(this->pin) == NOT_AN_INTERRUPT){
+            return false;
+        }
+#endif
+        for(unsigned char k = 0; k < SCHEDULE_PIN_EDGES; k++){
+            if(!handlers()[k]){
+                handlers()[k] = this;
+                this->isr_slot = k;
+                int mode = this->edges == BOTH_EDGES ? CHANGE : (this->edges == RISING_EDGE ? RISING : FALLING);
+                attachInterrupt(digitalPinToInterrupt(this->pin), ISRs<SCHEDULE_PIN_EDGES>::get(k), mode);
+                return true;
+            }
+        }
+        return false;
+    } // #attach
+
+    /* Detaches this Event from its Pin's Interrupt. */
+    void detach(){
+        if(this->isr_slot < SCHEDULE_PIN_EDGES){
+            detachInterrupt(digitalPinToInterrupt(this->pin));
+            handlers()[this->isr_slot] = nullptr;
+            this->isr_slot = 0xFF;
+        }
+    } // #detach
+#else
+    bool attach(){ return true; }
+    void detach(){ }
+#endif
+}; // Class: PinEdgeEvent
+#ifndef _CFCT_
+template <>
+struct PinEdgeEvent::ISRs<0>{
+    static void (*get(unsigned char))(){ return nullptr; }
+};
+#endif
+
+/*
+ * Schedule of Events. Conditional Events are polled on every #loop, while
+ * TimedEvents (which only need attention once their deadline passes) are kept
+ * in a min-heap ordered by deadline so a #loop where nothing is due costs O(1)
+ * and each firing costs O(log n).
+ * NOTE: ConditionalTimedEvents are polled, since their condition has to be
+ * watched every pass to know when to restart their timers.
+ */
 class Schedule{
 public:
-    std::vector<Event*> events;
+    // Polled Events (by type, in the order they were made):
+    std::vector<ConditionalEvent*> whiles; // WHILEs
+    std::vector<TransitionEvent*> whens; // WHENs
+    std::vector<ConditionalTimedEvent*> every_whiles; // EVERY_WHILEs
+    std::vector<TimedEvent*> timers; // Binary Min-Heap of TimedEvents by %deadline%
+    unsigned long oneshot_overflows = 0; // Number of Times #in_ Ran Out of Slots
+    volatile unsigned long trigger_overflows = 0; // Number of Times #trigger Found its Queue Full (written by the producer)
+    unsigned long passes = 0; // Number of Times #loop has Started
+    // Worst-Case Time between Consecutive Services of each Priority Class
+    // (passes for NORMAL, critical checks for CRITICAL):
+    schedule_time_t worst_latency[2] = {0, 0};
+    std::vector<Source*> sources; // Signals Made by #sample
+    std::vector<PinEdgeEvent*> pin_events; // Events Made by #onPinEdge
+    unsigned long pin_overflows = 0; // Number of Times #onPinEdge Couldn't Attach to an Interrupt
+    unsigned int ready_budget = SCHEDULE_READY_BUDGET; // Max Number of Ready Events Run per #loop
+    unsigned long ready_deferrals = 0; // Number of Passes which Left Ready Events for the Next (hit the %ready_budget%)
+    unsigned long budget_overruns = 0; // Number of Passes which Used up their Budget (see #loop)
+    unsigned long worst_overrun = 0; // Most a Pass has Gone over its Budget [us] (an action can't be cut short)
+
+    Schedule(){
+        for(unsigned char i = 0; i < SCHEDULE_ONESHOT_SLOTS; i++){
+            this->free_slots[i] = i;
+        }
+    } // ctor
+
+    /* Frees every Event (with its Actions), Task and Signal this Schedule
+     Made, and Clears its Pooled One-Shots. The done states of anything which
+     hadn't finished read as done (so what's chained onto them runs, and
+     mustn't use this Schedule). */
+    ~Schedule();
 
     /* Create an Event to be Triggered as Long as the Given Condition is True */
-    ConditionalEvent* while_( bool (*condition)() ){
+    ConditionalEvent* while_(ConditionalEvent::EventCondition condition){
         ConditionalEvent* e = new ConditionalEvent(condition);
-        this->events.push_back(e);
+        e->schedule = this;
+        this->poll(e);
+        this->adopt(e);
         return e;
     } // #while_
 
     /* Create an Event to be Triggered Once for Every Time the Given Condition
      Changes from false to true: */
-    TransitionEvent* when( bool (*condition)() ){
+    TransitionEvent* when(ConditionalEvent::EventCondition condition){
         TransitionEvent* e = new TransitionEvent(condition);
-        this->events.push_back(e);
+        e->schedule = this;
+        this->poll(e);
+        this->adopt(e);
         return e;
     } // #when
 
     /* Create an Event that will be Triggered Every %interval% Milliseconds */
-    TimedEvent* every(const unsigned long interval){
+    TimedEvent* every(const schedule_time_t interval){
         TimedEvent* e = new TimedEvent(interval);
-        this->events.push_back(e);
+        this->addTimer(e);
+        this->adopt(e);
         return e;
     } // #every
 
-    /* Create an Event that will be Triggered Once in %t% Milliseconds */
-    SingleTimedEvent* in_(const unsigned long t){
-        SingleTimedEvent* e = new SingleTimedEvent(t);
-        this->events.push_back(e);
+    /* Create an Event that will be Triggered Once in %t% Milliseconds.
+     Uses a free one-shot slot if there is one, otherwise allocates it. */
+    SingleTimedEvent* in_(const schedule_time_t t){
+        SingleTimedEvent* e = this->takeOneShot(t);
+        this->addTimer(e);
         return e;
     } // #in_
 
+    /* Create an Event that will be Triggered Once, as Soon as Possible. It
+     skips the timer heap and goes straight into the ready queue, so if it's
+     made by an action, it runs later in the same #loop (within the
+     %ready_budget%), otherwise at the start of the next one. */
+    SingleTimedEvent* now_(){
+        SingleTimedEvent* e = this->takeOneShot(0);
+        e->calledButNotRun = true;
+        e->status |= Event::READY;
+        e->in_ready = true;
+        this->ready.push_back(e);
+        return e;
+    } // #now_
+
+    /*
+     * Create an Event which is Triggered by the Given %edges% of Digital Pin
+     * %pin% (PinEdgeEvent::RISING_EDGE, FALLING_EDGE, or BOTH_EDGES), caught
+     * by its interrupt and run on the next #loop (once per edge). Counts a
+     * %pin_overflows% (and the Event never triggers) if the pin has no
+     * external interrupt (pin-change interrupts aren't used) or every one of
+     * the SCHEDULE_PIN_EDGES interrupts is taken.
+     */
+    PinEdgeEvent* onPinEdge(unsigned char pin, unsigned char edges = PinEdgeEvent::BOTH_EDGES){
+        PinEdgeEvent* e = new PinEdgeEvent(pin, edges);
+        e->schedule = this;
+        if(!e->attach()){
+            this->pin_overflows++;
+        }
+        this->pin_events.push_back(e);
+        this->adopt(e);
+        return e;
+    } // #onPinEdge
+
+    /* Create an Event which is only Triggered by #trigger (or Event#call,
+     which runs it from the ready queue). */
+    Event* onTrigger(){
+        Event* e = new Event();
+        e->schedule = this;
+        e->status |= Event::UNLISTED;
+        this->adopt(e);
+        return e;
+    } // #onTrigger
+
     /*
      * Create an Event that will be Triggered Every %interval% Milliseconds While
      * a Given Condition is True, starting %interval% Milliseconds AFTER the
      * Condition Becomes True.
      */
-    ConditionalTimedEvent* everyWhile(const unsigned long interval, bool (*condition)()){
+    ConditionalTimedEvent* everyWhile(const schedule_time_t interval, ConditionalTimedEvent::EventCondition condition){
         ConditionalTimedEvent* e = new ConditionalTimedEvent(interval, condition);
-        this->events.push_back(e);
+        e->schedule = this;
+        this->poll(e);
+        this->adopt(e);
         return e;
     } // #everyWhile
 
-    // Function to be Executed on Every Main Loop (as fast as possible)
-    void loop(){
-        // Iteration has to account for the fact that elements are intentionally
-        // deleted from the vector in the loop and potentially added at any call
-        // of #Event::tryExecute
-        std::vector<Event*>::size_type size = this->events.size();
-        std::vector<Event*>::size_type i = 0;
-        while(i < size){
-            if( this->events[i]->tryExecute() && this->events[i]->runs_once ){
-                // Delete Event if it's been Executed and Only Runs Once
-                delete this->events[i]; // Delete the Event
-                this->events.erase(this->events.begin() + i); // Remove the addr from the vector
-                size--; // As far as we know, the vector is now smaller
-            } else{
-                ++i; // Increment iterator normally
+    /*
+     * Create a Signal which Reads the Given Sensor Function at most Once per
+     * #loop (and at most once every %min_period% Milliseconds, if given), so
+     * any number of conditions can read the value without re-reading the
+     * hardware.
+     */
+    template <typename F>
+    auto sample(F sensor, const schedule_time_t min_period = 0) -> Signal<decltype(sensor())>*{
+        Signal<decltype(sensor())>* s = new Signal<decltype(sensor())>(this, sensor, min_period);
+        this->sources.push_back(s);
+        return s;
+    } // #sample
+
+    /*
+     * Function to be Executed on Every Main Loop (as fast as possible). Given a
+     * %budget_us%, it stops dispatching once the pass has taken that many
+     * microseconds (see passMicros; checked after each event, so every pass
+     * makes progress) and the next pass picks up where it left off, then
+     * wraps around to whatever it skipped, so no event is starved by the ones
+     * ahead of it (though a WHEN whose turn is put off only sees its
+     * condition as it is by then). CRITICAL events are still checked between
+     * every event. Passes which run out are counted in %budget_overruns%.
+     */
+    void loop(const unsigned long budget_us = 0){
+        this->passes++; // Lets Signals know their samples are from an old pass
+        this->pass_budget = budget_us;
+        if(budget_us){
+            this->pass_start = passMicros();
+        }
+        this->measureLatency(Event::NORMAL);
+        this->serviceCritical();
+        this->drainTriggers();
+        this->drainEdges();
+        this->ready_left = this->ready_budget;
+
+        // Run each Stage from where the Last Pass Stopped, Wrapping Around
+        // (each runs at most once a pass), until they're Done or the Budget is:
+        unsigned char stage = this->resume_stage;
+        unsigned char left = N_STAGES;
+        bool in_budget = this->drainReady();
+        while(in_budget && left > 0){
+            in_budget = this->runStage(stage);
+            if(in_budget){ // Ran to the End of the Stage
+                this->resume_index = 0;
+                stage = (stage + 1) % N_STAGES;
+                left--;
+                in_budget = this->drainReady() && !this->spent();
+            }
+        }
+        this->resume_stage = left > 0 ? stage : 0;
+        if(this->readyWaiting()){
+            this->ready_deferrals++;
+        }
+        if(!in_budget){
+            this->budget_overruns++;
+            unsigned long over = passMicros() - this->pass_start - budget_us;
+            if(over > this->worst_overrun){
+                this->worst_overrun = over;
             }
         }
+#ifdef SCHEDULE_THREADS
+        this->joinDispatched();
+#endif
     } // #loop
+
+    /*
+     * Runs a #loop (with the Given Budget, if any) then Sleeps until the Next
+     * Time there will be Something to Do (see #idleTime) or until #wake is
+     * Called. Conditions which have to be
+     * polled are polled at least every %poll_period% Milliseconds (with the
+     * default of 0, any polled event keeps this from sleeping at all).
+     * Sleeping uses the idle sleep mode on AVR, 1ms delays elsewhere on
+     * Arduino, and nanosleep on the host (or it just advances the VirtualClock).
+     */
+    void loopUntilNextDeadline(const schedule_time_t poll_period = 0, const unsigned long budget_us = 0){
+        this->loop(budget_us);
+        schedule_time_t idle = this->idleTime(poll_period);
+        if(idle > 0 && !this->woken){
+            this->sleepFor(idle);
+        }
+        this->woken = false;
+    } // #loopUntilNextDeadline
+
+#ifdef SCHEDULE_VIRTUAL_CLOCK
+    /*
+     * Runs every Pass that would Happen in the Next %duration% Ticks of
+     * Virtual Time, jumping the VirtualClock straight to the next thing to do
+     * between them (see #idleTime). Polled conditions are checked every
+     * %poll_period% ticks, and every pass takes at least one tick (so work that
+     * is always due can't stall the clock). Returns the Number of Passes Run.
+     */
+    unsigned long simulate(schedule_time_t duration, const schedule_time_t poll_period = 1){
+        schedule_time_t end = scheduleNow() + duration;
+        unsigned long n = 0;
+        while((schedule_diff_t)(end - scheduleNow()) > 0){
+            this->loop();
+            n++;
+            schedule_time_t idle = this->idleTime(poll_period);
+            schedule_time_t left = end - scheduleNow();
+            if(idle == 0){ idle = 1; }
+            VirtualClock::advance(idle < left ? idle : left);
+            this->woken = false;
+        }
+        return n;
+    } // #simulate
+#endif
+
+#ifdef SCHEDULE_PROFILE
+    /*
+     * Prints the Profile of every Lasting Event (and of all one-shots
+     * together, as "in_") to %out% (eg. Serial), one CSV row each:
+     *   name,triggers,total_us,max_us,late0/late1/.../lateN
+     * Events without a name (see Event#named) are numbered in the order they
+     * were made.
+     */
+    template <typename Out>
+    void dumpProfile(Out& out){
+        out.println("event,triggers,total_us,max_us,lateness");
+        for(std::vector<Event*>::size_type i = 0; i <= this->profiled.size(); i++){
+            const EventProfile& p = i < this->profiled.size() ? this->profiled[i]->profile : this->oneshot_profile;
+            if(i == this->profiled.size()){
+                out.print("in_");
+            } else if(this->profiled[i]->name){
+                out.print(this->profiled[i]->name);
+            } else{
+                out.print('#');
+                out.print((unsigned long) i);
+            }
+            out.print(',');
+            out.print(p.triggers);
+            out.print(',');
+            out.print(p.total_time);
+            out.print(',');
+            out.print(p.max_time);
+            out.print(',');
+            for(unsigned char b = 0; b < SCHEDULE_PROFILE_BINS; b++){
+                if(b > 0){ out.print('/'); }
+                out.print(p.lateness[b]);
+            }
+            out.println();
+        }
+    } // #dumpProfile
+
+    /* Clears every Profile. */
+    void resetProfile(){
+        for(std::vector<Event*>::size_type i = 0; i != this->profiled.size(); i++){
+            this->profiled[i]->profile = EventProfile();
+        }
+        this->oneshot_profile = EventProfile();
+    } // #resetProfile
+#endif
+
+    /*
+     * Queues the Given Event to be Executed at the Start of the Next #loop
+     * (and cuts short any sleep in #loopUntilNextDeadline). This is the only
+     * way to trigger an Event which is safe to call from an interrupt (or one
+     * other thread): it only writes to a fixed ring buffer, never allocating
+     * or touching the Schedule's lists. Only one producer (one interrupt, or
+     * interrupts which can't preempt each other) may call this at a time.
+     * Returns false (and counts it in %trigger_overflows%) if the queue is
+     * full. Events queued more than once run once per time they were queued.
+     */
+    bool trigger(Event* e){
+        unsigned char tail = __atomic_load_n(&this->trigger_tail, __ATOMIC_RELAXED); // Only the producer writes it
+        unsigned char next = (unsigned char)((tail + 1) % SCHEDULE_TRIGGER_QUEUE);
+        if(next == __atomic_load_n(&this->trigger_head, __ATOMIC_ACQUIRE)){
+            this->trigger_overflows = this->trigger_overflows + 1;
+            return false;
+        }
+        this->trigger_queue[tail] = e;
+        __atomic_store_n(&this->trigger_tail, next, __ATOMIC_RELEASE); // Publishes the slot
+        this->woken = true;
+        return true;
+    } // #trigger
+
+#ifdef SCHEDULE_THREADS
+    /* Runs the Functions of Independent Events (see Event#independent) on a
+     Pool of %n_threads% Workers (by default, one per core). 0 stops using
+     threads. */
+    void useThreads(unsigned int n_threads = std::thread::hardware_concurrency()){
+        delete this->pool;
+        this->pool = n_threads ? new WorkPool(n_threads) : nullptr;
+    } // #useThreads
+#endif
+
+    /* Cuts Short any Sleep in #loopUntilNextDeadline (safe to call from an
+     interrupt or another thread). */
+    void wake(){
+        this->woken = true;
+    } // #wake
+
+    /*
+     * Starts Running the Given Task Body, right away up until its first wait.
+     * Returns an ActionState which is done once the Task Finishes.
+     */
+    ActionState spawn(Task::function f){
+        Task* t = new Task(f);
+        ActionState d = t->done;
+        t->resume();
+        if(t->finished){
+            delete t;
+        } else{
+            this->tasks.push_back(t);
+        }
+        return d;
+    } // #spawn
+
+    /*
+     * Returns the Time until this Schedule Next Has Work: until the earliest
+     * timer is due, or at most %poll_period% if any Events or Signals have to
+     * be polled. Returns 0 if something has to run on the very next pass and
+     * the largest schedule_time_t if nothing is pending at all.
+     */
+    schedule_time_t idleTime(const schedule_time_t poll_period = 0){
+        if(this->resume_stage != 0 || !this->due.empty() || this->readyWaiting() || !this->dirty.empty() || !this->held.empty() || this->triggersPending()){
+            return 0;
+        }
+        for(std::vector<PinEdgeEvent*>::size_type i = 0; i != this->pin_events.size(); i++){
+            if(this->pin_events[i]->edgesPending()){
+                return 0;
+            }
+        }
+
+        schedule_time_t idle = (schedule_time_t) -1;
+        bool polling = !this->whiles.empty() || !this->whens.empty() || !this->every_whiles.empty() || !this->criticals.empty();
+        for(std::vector<Task*>::size_type i = 0; !polling && i != this->tasks.size(); i++){
+            polling = this->tasks[i]->polling;
+        }
+        for(std::vector<Source*>::size_type i = 0; !polling && i != this->sources.size(); i++){
+            polling = this->sourceWatched(i);
+        }
+        if(polling){
+            idle = poll_period;
+        }
+
+        if(!this->timers.empty()){
+            // Timers fire once their deadline has passed, so wake just after it:
+            schedule_diff_t until = (schedule_diff_t)(this->timers[0]->deadline - scheduleNow()) + 1;
+            if(until <= 0){
+                return 0;
+            }
+            if((schedule_time_t) until < idle){
+                idle = until;
+            }
+        }
+        for(std::vector<Task*>::size_type i = 0; i != this->tasks.size(); i++){
+            if(!this->tasks[i]->polling){ // Same as timers
+                schedule_diff_t until = (schedule_diff_t)(this->tasks[i]->wake - scheduleNow()) + 1;
+                if(until <= 0){
+                    return 0;
+                }
+                if((schedule_time_t) until < idle){
+                    idle = until;
+                }
+            }
+        }
+        return idle;
+    } // #idleTime
+
+protected:
+    friend class Event;
+    friend class TimedEvent;
+    friend class ConditionalEvent;
+    friend class Source;
+    std::vector<Event*> ready; // Ready Queue: NOW Events and Unpolled Events Called Directly, in the Order Queued
+    std::vector<Event*>::size_type ready_head = 0; // First Event in %ready% yet to Run (those before it have)
+    unsigned int ready_left = 0; // Number of Ready Events this Pass can still Run
+    // Stages of a Pass, in Order (a budgeted #loop can stop part-way through
+    // one and pick up there on the next pass):
+    enum Stage{ TIMER_STAGE, TASK_STAGE, WHILE_STAGE, WHEN_STAGE, EVERY_WHILE_STAGE, REACTION_STAGE, HELD_STAGE, N_STAGES };
+    unsigned char resume_stage = TIMER_STAGE; // Stage the Next Pass Starts in
+    std::vector<Event*>::size_type resume_index = 0; // Where in that Stage's List it Starts
+    unsigned long pass_start = 0; // passMicros() at the Start of the Current Pass
+    unsigned long pass_budget = 0; // Budget of the Current Pass [us] (0 for none)
+    std::vector<TimedEvent*> due; // Scratch Space for the TimedEvents Due in a Pass
+    std::vector<ConditionalEvent*> dirty; // Reactive Events whose Inputs Changed
+    std::vector<ConditionalEvent*> held; // Reactive WHILEs whose Conditions Currently Hold
+    std::vector<Task*> tasks; // Spawned Tasks which haven't Finished
+#ifdef SCHEDULE_THREADS
+    WorkPool* pool = nullptr; // Runs the Functions of Independent Events (if set)
+    std::vector<ActionState> dispatched; // Done States of Functions Handed to the %pool% this Pass
+    std::vector<Event*> dispatchers; // Events whose Functions were Handed to the %pool% this Pass
+
+    /* Waits for every Function Handed to the %pool% this Pass, then Marks them
+     Done and Settles their Events (done states are only touched from this
+     thread). */
+    void joinDispatched(){
+        if(!this->dispatched.empty()){
+            this->pool->wait();
+            for(std::vector<ActionState>::size_type i = 0; i != this->dispatched.size(); i++){
+                this->dispatched[i].set(true);
+            }
+            this->dispatched.clear();
+            for(std::vector<Event*>::size_type i = 0; i != this->dispatchers.size(); i++){
+                this->dispatchers[i]->awaiting_workers = false;
+                this->dispatchers[i]->settle();
+            }
+            this->dispatchers.clear();
+        }
+    } // #joinDispatched
+#endif
+#ifdef SCHEDULE_PROFILE
+    std::vector<Event*> profiled; // Every Lasting Event Made by this Schedule
+    EventProfile oneshot_profile; // Profiles of every One-Shot which has Retired
+#endif
+
+    std::vector<Event*> owned; // Every Event this Schedule Allocated which hasn't been Freed
+
+    /* Takes Ownership of the Given (allocated) Event, so it's freed with the
+     Schedule, and Adds it (if lasting) to the Table in #dumpProfile. */
+    void adopt(Event* e){
+        e->owned_index = this->owned.size();
+        this->owned.push_back(e);
+#ifdef SCHEDULE_PROFILE
+        if(!e->runs_once){
+            e->profile_index = this->profiled.size();
+            this->profiled.push_back(e);
+        }
+#endif
+    } // #adopt
+    volatile bool woken = false; // Whether #wake was Called since the Last Sleep
+
+    // Single-Producer / Single-Consumer Ring of Events Queued by #trigger. The
+    // producer only writes %trigger_tail% and the #loop only writes
+    // %trigger_head% (both single bytes, so they're read and written
+    // atomically even on AVR):
+    Event* trigger_queue[SCHEDULE_TRIGGER_QUEUE];
+    unsigned char trigger_head = 0; // Next Slot to Run
+    unsigned char trigger_tail = 0; // Next Slot to Fill
+
+    /* Returns Whether any Event is Waiting in the Ready Queue. */
+    bool readyWaiting() const{
+        return this->ready_head != this->ready.size();
+    } // #readyWaiting
+
+    /* Returns Whether any #trigger is Waiting to Run. */
+    bool triggersPending(){
+        return __atomic_load_n(&this->trigger_tail, __ATOMIC_ACQUIRE) != __atomic_load_n(&this->trigger_head, __ATOMIC_RELAXED);
+    } // #triggersPending
+
+    /* Executes every Event which was Queued by #trigger before this Started
+     (later triggers wait for the next pass, so a producer which keeps
+     triggering can't hold up the rest of the #loop). */
+    void drainTriggers(){
+        unsigned char head = __atomic_load_n(&this->trigger_head, __ATOMIC_RELAXED);
+        const unsigned char tail = __atomic_load_n(&this->trigger_tail, __ATOMIC_ACQUIRE);
+        while(head != tail){
+            Event* e = this->trigger_queue[head];
+            head = (unsigned char)((head + 1) % SCHEDULE_TRIGGER_QUEUE);
+            __atomic_store_n(&this->trigger_head, head, __ATOMIC_RELEASE); // Frees the slot for the producer
+            if(e && e->isActive()){
+                e->execute();
+                if((e->status & Event::CANCELLED) && (e->status & Event::UNLISTED)){ // Cancelled Itself
+                    this->retire(e);
+                }
+                this->serviceCritical();
+            }
+        }
+    } // #drainTriggers
+
+    /* Drops any #trigger of the Given (Retiring) Event which hasn't Run yet. */
+    void forgetTriggers(Event* e){
+        unsigned char i = __atomic_load_n(&this->trigger_head, __ATOMIC_RELAXED);
+        const unsigned char tail = __atomic_load_n(&this->trigger_tail, __ATOMIC_ACQUIRE);
+        for(; i != tail; i = (unsigned char)((i + 1) % SCHEDULE_TRIGGER_QUEUE)){
+            if(this->trigger_queue[i] == e){
+                this->trigger_queue[i] = nullptr; // Published Slots are the Loop's till it Moves %trigger_head% past them
+            }
+        }
+    } // #forgetTriggers
+
+    /* Runs every PinEdgeEvent once for each Edge it has Caught (paused ones
+     let theirs go), and Frees the Cancelled ones. */
+    void drainEdges(){
+        for(std::vector<PinEdgeEvent*>::size_type i = 0; i < this->pin_events.size(); i++){
+            PinEdgeEvent* e = this->pin_events[i];
+            if(e->status & Event::CANCELLED){
+                e->detach();
+                this->pin_events.erase(this->pin_events.begin() + i);
+                i--;
+                this->retire(e);
+                continue;
+            }
+            while(e->nextEdge()){
+                if(e->isActive()){
+                    e->execute();
+                    this->serviceCritical();
+                }
+            }
+        }
+    } // #drainEdges
+
+    bool sourceWatched(std::vector<Source*>::size_type i) const;
+
+    /* Sleeps for %t% Ticks or until #wake is Called. */
+    void sleepFor(schedule_time_t t){
+#if defined(SCHEDULE_VIRTUAL_CLOCK)
+        if(!this->woken){
+            VirtualClock::advance(t);
+        }
+#elif defined(_CFCT_)
+        // Sleep in Slices so a #wake from another thread is noticed quickly:
+        const schedule_time_t max_slice = 10 * SCHEDULE_TICKS_PER_MS;
+        while(t > 0 && !this->woken){
+            schedule_time_t slice = t < max_slice ? t : max_slice;
+            struct timespec ts;
+            ts.tv_sec = 0;
+            ts.tv_nsec = slice * (1000000L / SCHEDULE_TICKS_PER_MS);
+            nanosleep(&ts, nullptr);
+            t -= slice;
+        }
+#elif defined(__AVR__)
+        // Idle Mode Keeps Timer0 Running, whose Interrupt Wakes the CPU Every
+        // ~1ms, so only sleep while there's at least that long left:
+        schedule_time_t start = scheduleNow();
+        set_sleep_mode(SLEEP_MODE_IDLE);
+        while(!this->woken && scheduleNow() - start < t){
+            if(t - (scheduleNow() - start) > SCHEDULE_TICKS_PER_MS){
+                sleep_mode();
+            }
+        }
+#else
+        schedule_time_t start = scheduleNow();
+        while(!this->woken && scheduleNow() - start < t){
+            if(t - (scheduleNow() - start) > SCHEDULE_TICKS_PER_MS){
+                delay(1); // Yields to the Core (and lets it Power Down the Radio on the ESP)
+            }
+        }
+#endif
+    } // #sleepFor
+
+    /* Takes a Free One-Shot Slot and Arms it to Trigger in %t% Ticks, or
+     Allocates a New Event if there are None. */
+    SingleTimedEvent* takeOneShot(const schedule_time_t t){
+        if(this->n_free_slots > 0){
+            SingleTimedEvent* e = &(this->oneshots[this->free_slots[this->free_head]]);
+            this->free_head = (this->free_head + 1) % SCHEDULE_ONESHOT_SLOTS;
+            this->n_free_slots--;
+            e->arm(t);
+            return e;
+        }
+        this->oneshot_overflows++;
+        SingleTimedEvent* e = new SingleTimedEvent(t);
+        this->adopt(e);
+        return e;
+    } // #takeOneShot
+
+    /* Runs Events from the Front of the Ready Queue until it's Empty or this
+     Pass has Used up its %ready_budget%. Events queued by these actions are
+     run too (budget permitting), so a NOW doesn't wait for the next pass.
+     Returns false if it Stopped because the Pass is out of Time (see #spent). */
+    bool drainReady(){
+        bool in_budget = true;
+        while(this->ready_head != this->ready.size() && this->ready_left > 0){
+            Event* e = this->ready[this->ready_head++];
+            e->in_ready = false;
+            if(!e->calledButNotRun){ continue; } // Already Ran off its Timer
+            e->calledButNotRun = false; // Cleared First, so its Action can Call it Again
+            if(e->status & Event::CANCELLED){
+                if(e->status & Event::READY){ this->retire(e); } // In no other List
+                continue;
+            } else if(e->status & Event::PAUSED){ // Calls while Paused are Dropped
+                if(e->status & Event::READY){ // Parked like a Timer, so it Runs once Resumed
+                    e->status = (unsigned char)((e->status & ~Event::READY) | Event::PARKED | Event::PARKED_TIMER);
+                }
+                continue;
+            }
+            this->ready_left--;
+            e->execute();
+            if((e->status & Event::READY) || (e->status & (Event::CANCELLED | Event::UNLISTED)) == (Event::CANCELLED | Event::UNLISTED)){ // Done, or Cancelled Itself
+                this->retire(e);
+            }
+            this->serviceCritical();
+            if(this->spent()){
+                in_budget = false;
+                break;
+            }
+        }
+        // Drop what's Run once it's Most of the Queue (so each Event Popped
+        // costs the same however many are Queued):
+        if(this->ready_head == this->ready.size()){
+            this->ready.clear(); // Keeps its Capacity
+            this->ready_head = 0;
+        } else if(this->ready_head > this->ready.size() / 2){
+            this->ready.erase(this->ready.begin(), this->ready.begin() + this->ready_head);
+            this->ready_head = 0;
+        }
+        return in_budget;
+    } // #drainReady
+
+    /* Returns Whether the Current Pass has Used up its Budget (never, if it
+     doesn't have one). */
+    bool spent() const{
+        return this->pass_budget && passMicros() - this->pass_start >= this->pass_budget;
+    } // #spent
+
+    /* Runs the Given Stage of a Pass from %resume_index%. Returns false if it
+     Stopped Part-way because the Pass is out of Time (leaving %resume_index%
+     where the next pass should pick up). */
+    bool runStage(unsigned char stage){
+        switch(stage){
+            case TIMER_STAGE: return this->runTimers();
+            case TASK_STAGE: return this->resumeTasks();
+            // Polled Events are kept in one List per Type, so each is Checked
+            // in a Tight Loop without Virtual Calls:
+            case WHILE_STAGE: return this->pollBucket(this->whiles);
+            case WHEN_STAGE: return this->pollBucket(this->whens);
+            case EVERY_WHILE_STAGE: return this->pollBucket(this->every_whiles);
+            case REACTION_STAGE: return this->propagate();
+            default: return this->runHeld();
+        }
+    } // #runStage
+
+    /*
+     * Runs every TimedEvent that's Due. They're all Pulled out of the Heap
+     * before any of them Run, so Events that are Added or Re-Armed by these
+     * Actions Wait for the Next Pass (one execution per event per pass; NOWs
+     * they make go to the ready queue instead). Any a pass runs out of time
+     * for are Left in %due% for the next, which only Runs those (so the
+     * later stages get their turn). Returns false if any are Left.
+     */
+    bool runTimers(){
+        schedule_time_t now = scheduleNow();
+        if(this->due.empty()){
+            while(!this->timers.empty() && this->timers[0]->isDue(now)){
+                this->due.push_back(this->popTimer());
+            }
+        }
+        for(std::vector<TimedEvent*>::size_type i = 0; i != this->due.size(); i++){
+            TimedEvent* e = this->due[i];
+            if(e->status & Event::CANCELLED){
+                this->retire(e);
+                continue;
+            } else if(e->status & Event::PAUSED){
+                e->status |= Event::PARKED | Event::PARKED_TIMER; // Stays out of the Heap until resumed
+                continue;
+            }
+            e->profileLateness(now);
+            e->advance(now);
+            e->execute();
+            e->calledButNotRun = false;
+            if(e->runs_once){
+                this->retire(e);
+            } else{
+                this->pushTimer(e);
+            }
+            this->serviceCritical();
+            if(i + 1 != this->due.size() && this->spent()){
+                this->due.erase(this->due.begin(), this->due.begin() + i + 1);
+                return false;
+            }
+        }
+        this->due.clear();
+        return true;
+    } // #runTimers
+
+    // Preallocated One-Shot Events and a Ring of the Indices of those which
+    // are Free (taken from the head, returned to the tail):
+    SingleTimedEvent oneshots[SCHEDULE_ONESHOT_SLOTS];
+    unsigned char free_slots[SCHEDULE_ONESHOT_SLOTS];
+    unsigned char free_head = 0;
+    unsigned char n_free_slots = SCHEDULE_ONESHOT_SLOTS;
+
+    /* Runs the Reactive Events: Re-Samples any Signal Something Depends on,
+     then Re-Evaluates only the Events whose Inputs Changed. Returns false if
+     the Pass Ran out of Time Part-way (the rest stay queued, and the next
+     pass only looks at those, keeping their count in %resume_index%). */
+    bool propagate();
+
+    /* Runs every Reactive WHILE which is Holding, from %resume_index%.
+     Returns false if the Pass Ran out of Time Part-way. */
+    bool runHeld();
+
+    /* Queues a Reactive Event to be Re-Evaluated in the Next #propagate. */
+    void queueDirty(ConditionalEvent* e){
+        if(!e->queued){
+            e->queued = true;
+            this->dirty.push_back(e);
+        }
+    } // #queueDirty
+
+    /* Adds / Removes a Reactive WHILE from the Set which Runs Every Pass. */
+    void hold(ConditionalEvent* e, bool h){
+        if(h && !e->holding){
+            e->held_index = this->held.size();
+            this->held.push_back(e);
+        } else if(!h && e->holding){
+            ConditionalEvent* last = this->held.back(); // Swap and Pop
+            this->held[e->held_index] = last;
+            last->held_index = e->held_index;
+            this->held.pop_back();
+        }
+        e->holding = h;
+    } // #hold
+
+    std::vector<Event*> criticals; // CRITICAL Events (polled between other events)
+    bool servicing = false; // Whether #serviceCritical is Running (keeps it from nesting)
+    schedule_time_t last_service[2] = {0, 0}; // Time each Priority Class was Last Serviced
+
+    /* Resumes every Task that's Due (deleting those which Finish). */
+    bool resumeTasks(){
+        schedule_time_t now = scheduleNow();
+        std::vector<Task*>::size_type i = this->resume_index;
+        while(i < this->tasks.size()){ // Tasks spawned by these may be resumed this pass too
+            Task* t = this->tasks[i];
+            if(!t->isDue(now)){
+                ++i;
+                continue;
+            }
+            t->resume();
+            if(t->finished){
+                this->tasks[i] = this->tasks.back();
+                this->tasks.pop_back();
+                delete t;
+            } else{
+                ++i;
+            }
+            this->serviceCritical();
+            if(i < this->tasks.size() && this->spent()){
+                this->resume_index = i;
+                return false;
+            }
+        }
+        return true;
+    } // #resumeTasks
+
+    /* Records the Time since the Given Priority Class was Last Serviced. */
+    void measureLatency(unsigned char priority){
+        schedule_time_t now = scheduleNow();
+        schedule_time_t gap = now - this->last_service[priority];
+        if(this->passes > 1 && gap > this->worst_latency[priority]){
+            this->worst_latency[priority] = gap;
+        }
+        this->last_service[priority] = now;
+    } // #measureLatency
+
+    /* Checks (and Runs if Triggered) every CRITICAL Event. */
+    void serviceCritical(){
+        if(this->servicing || this->criticals.empty()){ return; }
+        this->servicing = true;
+        this->measureLatency(Event::CRITICAL);
+        // Events Done With are Dropped by Compacting the List in Place as it's
+        // Walked (see #pollBucket). Events made critical by these actions land
+        // past %size% and are only moved down.
+        std::vector<Event*>::size_type size = this->criticals.size();
+        std::vector<Event*>::size_type kept = 0;
+        for(std::vector<Event*>::size_type i = 0; i < size; i++){
+            Event* e = this->criticals[i];
+            if(this->dropInactive(e)){ continue; }
+            if(e->tryExecute() && e->runs_once){ // Only SingleTimedEvents Run Once
+                this->retire(e);
+            } else{
+                this->criticals[kept++] = e;
+            }
+        }
+        this->criticals.erase(this->criticals.begin() + kept, this->criticals.begin() + size);
+        this->servicing = false;
+    } // #serviceCritical
+
+    /*
+     * Polls every Event in the Given Bucket, all of Type T, so T's
+     * #shouldTrigger is Called Directly (rather than through the vtable).
+     * Events which are cancelled or paused are Dropped by Compacting the
+     * Bucket in Place as it's Walked, so removing one costs nothing extra and
+     * the rest keep their order. Events added by these actions land past
+     * %size% and are only moved down. Starts from %resume_index% and Returns
+     * false if the Pass Ran out of Time Part-way (see #runStage).
+     */
+    template <typename T>
+    bool pollBucket(std::vector<T*>& bucket){
+        typename std::vector<T*>::size_type size = bucket.size();
+        typename std::vector<T*>::size_type kept = this->resume_index < size ? this->resume_index : size;
+        for(typename std::vector<T*>::size_type i = kept; i < size; i++){
+            T* e = bucket[i];
+            if(this->dropInactive(e)){ continue; }
+            bucket[kept++] = e;
+            if(e->T::shouldTrigger() || e->calledButNotRun){ // Call #shouldTrigger first
+                e->execute();
+                e->calledButNotRun = false;
+                this->serviceCritical();
+                if(i + 1 < size && this->spent()){ // Closes the Gap, and the Next Pass Starts after this Event
+                    bucket.erase(bucket.begin() + kept, bucket.begin() + i + 1);
+                    this->resume_index = kept;
+                    return false;
+                }
+            }
+        }
+        bucket.erase(bucket.begin() + kept, bucket.begin() + size);
+        return true;
+    } // #pollBucket
+
+    /* Retires the Given Event if it's Cancelled or Parks it if it's Paused,
+     in which case the caller must drop it. Returns Whether it was. */
+    bool dropInactive(Event* e){
+        if(e->status & Event::CANCELLED){
+            this->retire(e);
+            return true;
+        } else if(e->status & Event::PAUSED){
+            e->status |= Event::PARKED;
+            return true;
+        }
+        return false;
+    } // #dropInactive
+
+    /* Adds the Given Event to its Type's Bucket of Polled Events. */
+    void poll(ConditionalEvent* e){
+        e->bucket = Event::WHILE_BUCKET;
+        this->whiles.push_back(e);
+    } // #poll
+    void poll(TransitionEvent* e){
+        e->bucket = Event::WHEN_BUCKET;
+        this->whens.push_back(e);
+    } // #poll
+    void poll(ConditionalTimedEvent* e){
+        e->bucket = Event::EVERY_WHILE_BUCKET;
+        this->every_whiles.push_back(e);
+    } // #poll
+
+    /* Puts the Given Event back into the Bucket it was Polled from. */
+    void repoll(Event* e){
+        switch(e->bucket){
+            case Event::WHILE_BUCKET: this->poll(static_cast<ConditionalEvent*>(e)); break;
+            case Event::WHEN_BUCKET: this->poll(static_cast<TransitionEvent*>(e)); break;
+            case Event::EVERY_WHILE_BUCKET: this->poll(static_cast<ConditionalTimedEvent*>(e)); break;
+            default: break;
+        }
+    } // #repoll
+
+    /* Takes the Given Event out of its Bucket for Good (it's no longer polled). */
+    void unpoll(Event* e){
+        switch(e->bucket){
+            case Event::WHILE_BUCKET: this->unlist(this->whiles, e); break;
+            case Event::WHEN_BUCKET: this->unlist(this->whens, e); break;
+            case Event::EVERY_WHILE_BUCKET: this->unlist(this->every_whiles, e); break;
+            default: break;
+        }
+        e->bucket = Event::UNPOLLED;
+    } // #unpoll
+
+    /* Erases the Given Event from the Given List (if it's there). */
+    template <typename T>
+    void unlist(std::vector<T*>& list, Event* e){
+        for(typename std::vector<T*>::size_type i = 0; i != list.size(); i++){
+            if(list[i] == e){
+                list.erase(list.begin() + i);
+                return;
+            }
+        }
+    } // #unlist
+
+    /* Frees the Given Event once it's been Cancelled (see Event#cancel). */
+    void cancelEvent(Event* e){
+        if(e->status & Event::CANCELLED){ return; }
+        e->status |= Event::CANCELLED;
+        if(e->status & Event::REACTIVE){ // No Source will Queue it again, so #propagate Frees it Next
+            static_cast<ConditionalEvent*>(e)->unsubscribe();
+            this->queueDirty(static_cast<ConditionalEvent*>(e));
+        } else if(e->status & Event::UNLISTED){
+            if(!e->executing){ // Otherwise Freed once it's Done (see #drainTriggers)
+                this->retire(e);
+            }
+        } else if(e->status & Event::PARKED){ // In none of the Lists, so Nothing will Come Across It
+            this->retire(e);
+        }
+    } // #cancelEvent
+
+    /* Puts a Resumed Event back into the List it was Parked from (if it was). */
+    void resumeEvent(Event* e){
+        if(!(e->status & Event::PARKED) || (e->status & Event::CANCELLED)){ return; }
+        if(e->status & Event::TIMED){
+            TimedEvent* t = static_cast<TimedEvent*>(e);
+            t->deadline = scheduleNow() + t->interval;
+        }
+        if(e->status & Event::PARKED_TIMER){
+            this->pushTimer(static_cast<TimedEvent*>(e));
+        } else if(e->priority == Event::CRITICAL){
+            this->criticals.push_back(e);
+        } else{
+            this->repoll(e);
+        }
+        e->status &= ~(Event::PARKED | Event::PARKED_TIMER);
+    } // #resumeEvent
+
+    /* Moves the Given Event into the CRITICAL Class. */
+    void makeCritical(Event* e){
+        this->unpoll(e);
+        e->status &= ~Event::UNLISTED;
+        for(std::vector<TimedEvent*>::size_type i = 0; i != this->timers.size(); i++){
+            if(this->timers[i] == e){ // Critical Events are Polled, not Queued
+                this->removeTimer(i);
+                break;
+            }
+        }
+        for(std::vector<TimedEvent*>::size_type i = 0; i != this->due.size(); i++){
+            if(this->due[i] == e){ // Left for the Next Pass by a Budgeted #loop
+                this->due.erase(this->due.begin() + i);
+                break;
+            }
+        }
+        e->priority = Event::CRITICAL;
+        this->criticals.push_back(e);
+    } // #makeCritical
+
+    /* Returns Whether TimedEvent %a% is Due Before TimedEvent %b% (rollover-safe). */
+    static bool earlier(const TimedEvent* a, const TimedEvent* b){
+        return timePassed(b->deadline, a->deadline);
+    } // #earlier
+
+    /* Registers the Given TimedEvent with this Schedule's Timer Queue. */
+    void addTimer(TimedEvent* e){
+        e->schedule = this;
+        this->pushTimer(e);
+    } // #addTimer
+
+    /* Inserts the Given TimedEvent into the %timers% Heap. */
+    void pushTimer(TimedEvent* e){
+        this->timers.push_back(e);
+        this->siftUp(this->timers.size() - 1);
+    } // #pushTimer
+
+    /* Removes and Returns the TimedEvent with the Earliest Deadline. */
+    TimedEvent* popTimer(){
+        TimedEvent* top = this->timers[0];
+        this->removeTimer(0);
+        return top;
+    } // #popTimer
+
+    /* Removes the TimedEvent at Position %i% of the %timers% Heap. */
+    void removeTimer(std::vector<TimedEvent*>::size_type i){
+        this->timers[i] = this->timers.back();
+        this->timers.pop_back();
+        if(i < this->timers.size()){
+            this->siftDown(i);
+            this->siftUp(i);
+        }
+    } // #removeTimer
+
+    /* Moves the TimedEvent at Position %i% Up the Heap until it's in Order. */
+    void siftUp(std::vector<TimedEvent*>::size_type i){
+        while(i > 0){
+            std::vector<TimedEvent*>::size_type parent = (i - 1) / 2;
+            if(!earlier(this->timers[i], this->timers[parent])){ break; }
+            TimedEvent* tmp = this->timers[i];
+            this->timers[i] = this->timers[parent];
+            this->timers[parent] = tmp;
+            i = parent;
+        }
+    } // #siftUp
+
+    /* Moves the TimedEvent at Position %i% Down the Heap until it's in Order. */
+    void siftDown(std::vector<TimedEvent*>::size_type i){
+        std::vector<TimedEvent*>::size_type n = this->timers.size();
+        while(true){
+            std::vector<TimedEvent*>::size_type l = 2*i + 1;
+            std::vector<TimedEvent*>::size_type r = l + 1;
+            std::vector<TimedEvent*>::size_type first = i;
+            if(l < n && earlier(this->timers[l], this->timers[first])){ first = l; }
+            if(r < n && earlier(this->timers[r], this->timers[first])){ first = r; }
+            if(first == i){ break; }
+            TimedEvent* tmp = this->timers[i];
+            this->timers[i] = this->timers[first];
+            this->timers[first] = tmp;
+            i = first;
+        }
+    } // #siftDown
+
+    /* Disposes of an Event which has Run its Course or been Cancelled (and is
+     no longer in any list): Pooled One-Shots go back on the ring of free
+     slots, anything else is deleted. */
+    void retire(Event* e){
+        if(this->triggersPending()){ // Nothing Left Pointing at it
+            this->forgetTriggers(e);
+        }
+#ifdef SCHEDULE_THREADS
+        if(e->awaiting_workers){ // Workers may still be Calling its Functions
+            this->pool->wait();
+            this->unlist(this->dispatchers, e);
+        }
+#endif
+#ifdef SCHEDULE_PROFILE
+        if(e->runs_once){
+            this->oneshot_profile.merge(e->profile);
+        } else{ // Swap and Pop
+            Event* last = this->profiled.back();
+            this->profiled[e->profile_index] = last;
+            last->profile_index = e->profile_index;
+            this->profiled.pop_back();
+        }
+#endif
+        if(e->in_ready){ // Only if it's Retired before its Turn (eg. Cancelled after a #call)
+            for(std::vector<Event*>::size_type i = this->ready_head; i != this->ready.size(); i++){
+                if(this->ready[i] == e){
+                    this->ready.erase(this->ready.begin() + i);
+                    break;
+                }
+            }
+            e->in_ready = false;
+        }
+        if(!(e->status & Event::TIMED)){
+            this->disown(e);
+            delete e;
+            return;
+        }
+        if(e->runs_once && e >= static_cast<Event*>(&(this->oneshots[0])) && e <= static_cast<Event*>(&(this->oneshots[SCHEDULE_ONESHOT_SLOTS - 1]))){
+            unsigned char k = (unsigned char)(static_cast<SingleTimedEvent*>(e) - this->oneshots);
+            e->clearRegistry(); // Frees the Actions now rather than when the slot is re-armed
+            unsigned char tail = (this->free_head + this->n_free_slots) % SCHEDULE_ONESHOT_SLOTS;
+            this->free_slots[tail] = k;
+            this->n_free_slots++;
+            return;
+        }
+        this->disown(e);
+        delete e;
+    } // #retire
+
+    /* Takes the Given Event (which is about to be Freed) out of %owned%. */
+    void disown(Event* e){ // Swap and Pop
+        Event* last = this->owned.back();
+        this->owned[e->owned_index] = last;
+        last->owned_index = e->owned_index;
+        this->owned.pop_back();
+    } // #disown
 }; // Class: Schedule
+
+inline void Event::call(){
+    if(this->status & UNLISTED){ // Nothing Polls it
+        this->queueCall();
+    } else{
+        this->calledButNotRun = true;
+    }
+} // #call
+
+/* Puts this Event in the owning Schedule's Ready Queue (once), so it Runs ASAP
+ (later in the same pass if called from an action). */
+inline void Event::queueCall(){
+    if(!this->in_ready && this->schedule){
+        this->in_ready = true;
+        this->schedule->ready.push_back(this);
+    }
+    this->calledButNotRun = true;
+} // #queueCall
+
+/* Request this Event to Execute ASAP (puts it in the owning Schedule's ready
+ queue since TimedEvents aren't polled, so a call from an action runs later in
+ the same pass). */
+inline void TimedEvent::call(){
+    this->queueCall();
+} // #call
+
+#ifdef SCHEDULE_THREADS
+/* Hands the Given Registered Function to the Schedule's Workers (or just calls
+ it, if the Schedule isn't using threads). */
+inline void Event::dispatch(Registered& r){
+    if(this->schedule && this->schedule->pool){
+        if(r.done.index == ActionState::NONE){ // Marked Done once the Worker is, at the End of the Pass
+            r.done = ActionState::make(false);
+            r.done.release();
+        }
+        if(!this->awaiting_workers){
+            this->awaiting_workers = true;
+            this->schedule->dispatchers.push_back(this);
+        }
+        RegisteredFunction* f = &(r.function); // Called in Place, so State it Captures Carries on to the Next Run
+        this->schedule->pool->submit([f](){ (*f)(); });
+        this->schedule->dispatched.push_back(r.done);
+    } else{
+        r.function();
+        r.finish();
+    }
+} // #dispatch
+
+/* Waits for the Workers to Finish any Functions of this Event they were Handed
+ Earlier in the Pass. */
+inline void Event::awaitWorkers(){
+    this->schedule->pool->wait();
+} // #awaitWorkers
+#endif
+
+/* Records an Edge at Time %t% (in micros) as if the Pin's Interrupt had Caught
+ it, and Wakes the Schedule. Drops it (counting an overflow) if this Event's
+ ring is full or it isn't listening to that kind of edge. */
+inline void PinEdgeEvent::inject(bool is_rising, unsigned long t){
+    if(!(this->edges & (is_rising ? RISING_EDGE : FALLING_EDGE))){
+        return;
+    }
+    unsigned char t_idx = __atomic_load_n(&this->tail, __ATOMIC_RELAXED); // Only the producer writes it
+    unsigned char next = (unsigned char)((t_idx + 1) % SCHEDULE_EDGE_QUEUE);
+    if(next == __atomic_load_n(&this->head, __ATOMIC_ACQUIRE)){
+        this->overflows = this->overflows + 1;
+        return;
+    }
+    this->ring[t_idx].time = t;
+    this->ring[t_idx].rising = is_rising;
+    __atomic_store_n(&this->tail, next, __ATOMIC_RELEASE);
+    if(this->schedule){
+        this->schedule->wake();
+    }
+} // #inject
+
+/*
+ * Anything Reactive Events can Depend on. Reading a Source while a Reactive
+ * Event is being evaluated subscribes that Event to it; when the Source's
+ * value changes, every subscriber is queued for re-evaluation.
+ */
+class Source{
+public:
+    virtual ~Source(){
+        for(std::vector<ConditionalEvent*>::size_type i = 0; i != this->dependents.size(); i++){
+            std::vector<Source*>& in = this->dependents[i]->inputs;
+            for(std::vector<Source*>::size_type j = 0; j != in.size(); j++){
+                if(in[j] == this){
+                    in.erase(in.begin() + j);
+                    break;
+                }
+            }
+        }
+    } // dtor
+
+    /* Brings the Value up to Date (if that needs to be done actively).
+     Called every pass by the Schedule for Sources with subscribers. */
+    virtual void refresh(){ }
+
+    /* Returns Whether any Reactive Event Depends on this Source. */
+    bool watched() const{ return !this->dependents.empty(); }
+
+    // Returns the Reactive Event being Evaluated right now (if any):
+    static ConditionalEvent*& tracker(){
+        static SCHEDULE_THREAD_LOCAL ConditionalEvent* e = nullptr;
+        return e;
+    } // #tracker
+
+protected:
+    friend class ConditionalEvent;
+    std::vector<ConditionalEvent*> dependents;
+
+    /* Subscribes the Event Currently Being Evaluated (if any) to this Source. */
+    void track(){
+        ConditionalEvent* e = tracker();
+        if(e){
+            for(std::vector<ConditionalEvent*>::size_type i = 0; i != this->dependents.size(); i++){
+                if(this->dependents[i] == e){ return; }
+            }
+            this->dependents.push_back(e);
+            e->inputs.push_back(this);
+        }
+    } // #track
+
+    /* Queues every Subscriber for Re-Evaluation. */
+    void changed(){
+        for(std::vector<ConditionalEvent*>::size_type i = 0; i != this->dependents.size(); i++){
+            this->dependents[i]->schedule->queueDirty(this->dependents[i]);
+        }
+    } // #changed
+}; // class Source
+
+/*
+ * Cached Sample of a Sensor Function. The sensor is only re-read when the
+ * Schedule has started a new pass since the last sample and at least
+ * %min_period% Milliseconds have passed since then. Signals which Reactive
+ * Events depend on are re-sampled by the Schedule every pass (subject to
+ * %min_period%) so those events hear about changes.
+ */
+template <typename T>
+class Signal : public Source{
+public:
+    typedef InlineFunction<T()> Sampler;
+
+    const schedule_time_t min_period; // Minimum Time between Samples
+
+    Signal(Schedule* s, Sampler f, schedule_time_t p) : min_period{p}, schedule{s}, sensor{f} {};
+
+    /* Returns the Latest Sample, Reading the Sensor if the Sample is Stale. */
+    T read(){
+        this->track();
+        this->refresh();
+        return this->value;
+    } // #read
+
+    T operator()(){ return this->read(); }
+
+    /* Reads the Sensor if the Sample is Stale. */
+    void refresh(){
+        if(!this->sampled || (this->pass != this->schedule->passes && scheduleNow() - this->sampled_at >= this->min_period)){
+            T v = this->sensor();
+            this->pass = this->schedule->passes;
+            this->sampled_at = scheduleNow();
+            if(!this->sampled || v != this->value){
+                this->value = v;
+                this->changed();
+            }
+            this->sampled = true;
+        }
+    } // #refresh
+
+protected:
+    Schedule* schedule;
+    Sampler sensor;
+    T value;
+    unsigned long pass = 0; // Schedule Pass in which the Last Sample was Taken
+    schedule_time_t sampled_at = 0; // Time of the Last Sample
+    bool sampled = false; // Whether the Sensor has Ever been Read
+}; // class Signal
+
+/*
+ * Value Set by the Program (rather than sampled) which Reactive Events can
+ * Depend on. Setting it to a new value queues its subscribers.
+ */
+template <typename T>
+class State : public Source{
+public:
+    State(T v = T()) : value{v} {};
+
+    T get(){
+        this->track();
+        return this->value;
+    } // #get
+
+    void set(T v){
+        if(v != this->value){
+            this->value = v;
+            this->changed();
+        }
+    } // #set
+
+protected:
+    T value;
+}; // class State
+
+/* Spawns a New Task unless the Last One is Still Running. */
+inline void ResumableAction::call(){
+    if(this->running.get()){
+        this->running = this->schedule->spawn(this->oncall);
+        this->done.follow(this->running);
+    }
+} // #call
+
+inline void Event::cancel(){
+    if(this->schedule){
+        this->schedule->cancelEvent(this);
+    } else{
+        this->status |= CANCELLED;
+    }
+} // #cancel
+
+inline void Event::resume(){
+    this->status &= ~PAUSED;
+    if(this->schedule){
+        this->schedule->resumeEvent(this);
+    }
+} // #resume
+
+inline void ConditionalEvent::resume(){
+    Event::resume();
+    if(this->is_reactive && this->isActive()){
+        this->schedule->queueDirty(this); // Inputs may have Changed while it was Paused
+    }
+} // #resume
+
+inline Event* Event::critical(){
+    if(this->priority != CRITICAL && this->schedule){
+        this->schedule->makeCritical(this);
+    }
+    return this;
+} // #critical
+
+inline ConditionalEvent* ConditionalEvent::reactive(){
+    if(!this->is_reactive && this->priority != Event::CRITICAL && this->schedule){
+        this->schedule->unpoll(this); // Stop Polling It
+        this->is_reactive = true;
+        this->status |= Event::REACTIVE;
+        this->schedule->queueDirty(this); // Evaluate it once to learn its inputs
+    }
+    return this;
+} // #reactive
+
+inline void ConditionalEvent::call(){
+    this->calledButNotRun = true;
+    if(this->is_reactive){
+        this->schedule->queueDirty(this); // Isn't polled, so make sure it's looked at
+    }
+} // #call
+
+inline bool ConditionalEvent::evaluate(){
+    ConditionalEvent*& tracker = Source::tracker();
+    ConditionalEvent* outer = tracker;
+    tracker = this;
+    bool result = this->condition();
+    tracker = outer;
+    return result;
+} // #evaluate
+
+inline void ConditionalEvent::unsubscribe(){
+    for(std::vector<Source*>::size_type i = 0; i != this->inputs.size(); i++){
+        std::vector<ConditionalEvent*>& d = this->inputs[i]->dependents;
+        for(std::vector<ConditionalEvent*>::size_type j = 0; j != d.size(); j++){
+            if(d[j] == this){
+                d.erase(d.begin() + j);
+                break;
+            }
+        }
+    }
+    this->inputs.clear();
+} // #unsubscribe
+
+inline void ConditionalEvent::react(){
+    bool holds = this->evaluate();
+    this->schedule->hold(this, holds); // Runs in this pass's sweep of held events if true
+    if(this->calledButNotRun && !holds){
+        this->execute();
+    }
+    this->calledButNotRun = false;
+} // #react
+
+inline bool Schedule::sourceWatched(std::vector<Source*>::size_type i) const{
+    return this->sources[i]->watched();
+} // #sourceWatched
+
+inline Schedule::~Schedule(){
+#ifdef SCHEDULE_THREADS
+    if(this->pool){ // Lets the Workers Finish first
+        this->joinDispatched();
+        delete this->pool;
+        this->pool = nullptr;
+    }
+#endif
+    for(std::vector<Source*>::size_type i = 0; i != this->sources.size(); i++){
+        delete this->sources[i]; // Drops itself from the Inputs of its Dependents
+    }
+    this->sources.clear();
+    for(std::vector<PinEdgeEvent*>::size_type i = 0; i != this->pin_events.size(); i++){
+        this->pin_events[i]->detach();
+    }
+    while(!this->owned.empty()){ // (from the back, as Freeing one can Make Another)
+        Event* e = this->owned.back();
+        this->owned.pop_back();
+        if(e->status & Event::REACTIVE){ // Otherwise States it Reads would still Point at it
+            static_cast<ConditionalEvent*>(e)->unsubscribe();
+        }
+        delete e;
+    }
+    for(unsigned char i = 0; i < SCHEDULE_ONESHOT_SLOTS; i++){
+        this->oneshots[i].clearRegistry();
+    }
+    for(std::vector<Task*>::size_type i = 0; i != this->tasks.size(); i++){
+        delete this->tasks[i];
+    }
+    this->tasks.clear();
+} // dtor
+
+inline bool Schedule::propagate(){
+    for(std::vector<Source*>::size_type i = 0; i != this->sources.size(); i++){
+        if(this->sources[i]->watched()){
+            this->sources[i]->refresh();
+        }
+    }
+
+    // Only Look at Events Queued before Now (events can re-queue each other):
+    std::vector<ConditionalEvent*>::size_type n_dirty = this->resume_index ? this->resume_index : this->dirty.size();
+    for(std::vector<ConditionalEvent*>::size_type i = 0; i < n_dirty; i++){
+        ConditionalEvent* e = this->dirty[i];
+        e->queued = false;
+        if(!e->isActive()){ // Reactive Events are only ever Switched Off
+            this->hold(e, false);
+            if(e->status & Event::CANCELLED){ // Unsubscribed, so this is the Last Anything Sees of it
+                this->retire(e);
+            }
+            continue;
+        }
+        e->react();
+        this->serviceCritical();
+        if(i + 1 < n_dirty && this->spent()){
+            this->dirty.erase(this->dirty.begin(), this->dirty.begin() + i + 1);
+            this->resume_index = n_dirty - (i + 1);
+            return false;
+        }
+    }
+    this->dirty.erase(this->dirty.begin(), this->dirty.begin() + n_dirty);
+    return true;
+} // #propagate
+
+inline bool Schedule::runHeld(){
+    std::vector<ConditionalEvent*>::size_type n_held = this->held.size();
+    for(std::vector<ConditionalEvent*>::size_type i = this->resume_index; i < n_held && i < this->held.size(); i++){
+        ConditionalEvent* e = this->held[i];
+        if(!e->isActive()){
+            this->hold(e, false); // Swaps the Last in, so Look at this Index Again
+            i--;
+            continue;
+        }
+        e->execute();
+        this->serviceCritical();
+        if(i + 1 < n_held && i + 1 < this->held.size() && this->spent()){
+            this->resume_index = i + 1;
+            return false;
+        }
+    }
+    return true;
+} // #runHeld
+
+/*
+ * Compact Record of Sensor Reads, Kept in a Ring of SCHEDULE_LOG_SIZE Bytes
+ * and Streamed out (eg. over Serial) with #flush, for SensorReplay to Play
+ * back on the Host. Wrap each raw read in #record (it returns the value):
+ *   Signal<float>* distance = sch->sample([](){ return sensor_log.record(0, sonar.measureDistanceCm()); });
+ * Each entry is one byte for the channel (and type of value), the time since
+ * the previous entry (varint, in Schedule ticks) and the value (zigzag
+ * varint for integers, 4 bytes for floats, nothing for bools). A read is
+ * only stored if it differs from the last one stored on its channel (replay
+ * holds the last value). If the ring is full, the read is dropped (and
+ * counted in %dropped%), so #flush often enough to keep up.
+ */
+class SensorLog{
+public:
+    static const unsigned char CHANNELS = 8; // Channels 0 to CHANNELS-1
+    // Types of Value (top two bits of an entry's first byte):
+    static const unsigned char INT_VALUE = 0x00;
+    static const unsigned char FLOAT_VALUE = 0x40;
+    static const unsigned char FALSE_VALUE = 0x80;
+    static const unsigned char TRUE_VALUE = 0xC0;
+
+    unsigned long dropped = 0; // Number of Reads which Didn't Fit in the Ring
+
+    SensorLog() : last_time{scheduleNow()} {};
+
+    /* Records the Given Read on %channel% and Returns it. */
+    long record(unsigned char channel, long value){
+        this->store(channel, INT_VALUE, (uint32_t) value);
+        return value;
+    } // #record
+    int record(unsigned char channel, int value){ return (int) this->record(channel, (long) value); }
+    unsigned int record(unsigned char channel, unsigned int value){ return (unsigned int) this->record(channel, (long) value); }
+    unsigned long record(unsigned char channel, unsigned long value){ return (unsigned long) this->record(channel, (long) value); }
+    bool record(unsigned char channel, bool value){
+        if(value){
+            this->store(channel, TRUE_VALUE, 1);
+        } else{
+            this->store(channel, FALSE_VALUE, 0);
+        }
+        return value;
+    } // #record
+    float record(unsigned char channel, float value){
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        this->store(channel, FLOAT_VALUE, bits);
+        return value;
+    } // #record
+    double record(unsigned char channel, double value){ return this->record(channel, (float) value); }
+
+    /* Writes every Byte Recorded since the Last Flush to %out% (anything with
+     a write(uint8_t), like Serial). */
+    template <typename Out>
+    void flush(Out& out){
+        while(this->used > 0){
+            out.write(this->ring[this->head]);
+            this->head = (this->head + 1) % SCHEDULE_LOG_SIZE;
+            this->used--;
+        }
+    } // #flush
+
+protected:
+    uint8_t ring[SCHEDULE_LOG_SIZE];
+    unsigned int head = 0; // Oldest Byte not yet Flushed
+    unsigned int used = 0; // Number of Bytes not yet Flushed
+    schedule_time_t last_time; // Time of the Last Entry Stored
+    uint32_t last_value[CHANNELS]; // Raw Value Last Stored on each Channel
+    unsigned char stored = 0; // Bit Mask of the Channels which have Stored a Value
+
+    /* Stores a Read (if it changed) as an Entry, or Drops it if it won't Fit. */
+    void store(unsigned char channel, unsigned char type, uint32_t raw){
+        if(channel >= CHANNELS){ return; }
+        if(type == TRUE_VALUE || type == FALSE_VALUE){ raw = type; }
+        if((this->stored & (1 << channel)) && this->last_value[channel] == raw){
+            return;
+        }
+
+        uint8_t entry[1 + 2 * 5];
+        unsigned char n = 0;
+        entry[n++] = type | channel;
+        schedule_time_t now = scheduleNow();
+        n += varint(entry + n, (uint32_t)(now - this->last_time));
+        if(type == INT_VALUE){
+            n += varint(entry + n, (raw << 1) ^ (uint32_t)((int32_t) raw >> 31)); // Zigzag: small magnitudes stay short
+        } else if(type == FLOAT_VALUE){
+            for(unsigned char i = 0; i < 4; i++){
+                entry[n++] = raw >> (8 * i);
+            }
+        }
+        if(this->used + n > SCHEDULE_LOG_SIZE){
+            this->dropped++;
+            return;
+        }
+        for(unsigned char i = 0; i < n; i++){
+            this->ring[(this->head + this->used) % SCHEDULE_LOG_SIZE] = entry[i];
+            this->used++;
+        }
+        this->last_time = now;
+        this->last_value[channel] = raw;
+        this->stored |= 1 << channel;
+    } // #store
+
+    /* Writes %v% as a Varint (7 bits per byte, low first) and Returns its Length. */
+    static unsigned char varint(uint8_t* out, uint32_t v){
+        unsigned char n = 0;
+        while(v >= 0x80){
+            out[n++] = (v & 0x7F) | 0x80;
+            v >>= 7;
+        }
+        out[n++] = v;
+        return n;
+    } // #varint
+}; // Class: SensorLog
+
+/*
+ * Plays a Stream Recorded by a SensorLog back: each #read returns the value
+ * the same channel had at the same time (relative to when recording started)
+ * in the recording, measured on the current Schedule clock. Running the same
+ * logic on a VirtualClock (see Schedule::simulate) replays a session as fast
+ * as it can be computed, and gives the same results every time.
+ */
+class SensorReplay{
+public:
+    SensorReplay(const uint8_t* data, unsigned long length) : data{data}, length{length}, start{scheduleNow()} {
+        for(unsigned char i = 0; i < SensorLog::CHANNELS; i++){
+            this->values[i] = 0;
+        }
+        this->decode(); // Stage the First Entry
+    } // ctor
+
+    /* Returns the Value of %channel% at the Current Time (as the type it was
+     recorded as). */
+    long readInteger(unsigned char channel){ return (long)(int32_t) this->at(channel); }
+    bool readBool(unsigned char channel){ return this->at(channel) == SensorLog::TRUE_VALUE; }
+    float readFloat(unsigned char channel){
+        uint32_t bits = this->at(channel);
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        return f;
+    } // #readFloat
+
+    /* Returns Whether every Entry has been Played. */
+    bool finished() const{ return !this->staged; }
+
+protected:
+    const uint8_t* data;
+    unsigned long length;
+    unsigned long cursor = 0; // Next Byte to Decode
+    schedule_time_t start; // Clock Time the Recording Lines up with
+    schedule_time_t elapsed = 0; // Recorded Time of the Staged Entry (since the start)
+    bool staged = false; // Whether an Entry is Waiting for its Time
+    unsigned char staged_channel = 0;
+    uint32_t staged_value = 0;
+    uint32_t values[SensorLog::CHANNELS]; // Current Value of each Channel
+
+    /* Plays every Entry which is Due, then Returns the Value of %channel%. */
+    uint32_t at(unsigned char channel){
+        schedule_time_t now = scheduleNow() - this->start;
+        while(this->staged && (schedule_diff_t)(now - this->elapsed) >= 0){
+            this->values[this->staged_channel] = this->staged_value;
+            this->decode();
+        }
+        return channel < SensorLog::CHANNELS ? this->values[channel] : 0;
+    } // #at
+
+    /* Decodes the Next Entry into the Stage (if there's a whole one left). */
+    void decode(){
+        this->staged = false;
+        if(this->cursor >= this->length){ return; }
+        uint8_t head = this->data[this->cursor++];
+        unsigned char type = head & 0xC0;
+        uint32_t dt, raw = type;
+        if(!this->varint(dt)){ return; }
+        if(type == SensorLog::INT_VALUE){
+            if(!this->varint(raw)){ return; }
+            raw = (raw >> 1) ^ (uint32_t)(-(int32_t)(raw & 1));
+        } else if(type == SensorLog::FLOAT_VALUE){
+            if(this->cursor + 4 > this->length){ return; }
+            raw = 0;
+            for(unsigned char i = 0; i < 4; i++){
+                raw |= (uint32_t) this->data[this->cursor++] << (8 * i);
+            }
+        }
+        this->elapsed += dt;
+        this->staged_channel = head & 0x3F;
+        this->staged_value = raw;
+        this->staged = this->staged_channel < SensorLog::CHANNELS;
+    } // #decode
+
+    /* Reads a Varint at the Cursor. Returns Whether it was Complete. */
+    bool varint(uint32_t& v){
+        v = 0;
+        for(unsigned char shift = 0; this->cursor < this->length && shift < 35; shift += 7){
+            uint8_t b = this->data[this->cursor++];
+            v |= (uint32_t)(b & 0x7F) << shift;
+            if(!(b & 0x80)){ return true; }
+        }
+        return false;
+    } // #varint
+}; // Class: SensorReplay
+
+/*
+ * Events for a StaticSchedule. Each is a plain object holding only its own
+ * state, with its functions baked in as template parameters so checking and
+ * calling them are direct calls the compiler can inline.
+ */
+// Calls %action% Every %interval% Milliseconds:
+template <schedule_time_t interval, void (*action)()>
+class Every{
+public:
+    schedule_time_t deadline = scheduleNow() + interval; // Time after which this is Next Due
+
+    void run(schedule_time_t now){
+        if(timePassed(now, this->deadline)){
+            this->deadline += interval;
+            action();
+        }
+    } // #run
+}; // class Every
+
+// Calls %action% Once, %t% Milliseconds after Startup:
+template <schedule_time_t t, void (*action)()>
+class In{
+public:
+    schedule_time_t deadline = scheduleNow() + t;
+    bool ran = false;
+
+    void run(schedule_time_t now){
+        if(!this->ran && timePassed(now, this->deadline)){
+            this->ran = true;
+            action();
+        }
+    } // #run
+}; // class In
+
+// Calls %action% Every Time %condition% Changes from false to true:
+template <bool (*condition)(), void (*action)()>
+class When{
+public:
+    bool last_state = false;
+
+    void run(schedule_time_t){
+        bool curr_state = condition();
+        if(curr_state && !this->last_state){
+            action();
+        }
+        this->last_state = curr_state;
+    } // #run
+}; // class When
+
+// Calls %action% Every Pass while %condition% is true:
+template <bool (*condition)(), void (*action)()>
+class While{
+public:
+    void run(schedule_time_t){
+        if(condition()){
+            action();
+        }
+    } // #run
+}; // class While
+
+// Calls %action% Every %interval% Milliseconds while %condition% is true,
+// starting %interval% Milliseconds after it becomes true:
+template <schedule_time_t interval, bool (*condition)(), void (*action)()>
+class EveryWhile{
+public:
+    schedule_time_t deadline = 0;
+    bool last_state = false;
+
+    void run(schedule_time_t now){
+        bool curr_state = condition();
+        if(curr_state && !this->last_state){
+            this->deadline = now + interval;
+        }
+        this->last_state = curr_state;
+        if(curr_state && timePassed(now, this->deadline)){
+            this->deadline += interval;
+            action();
+        }
+    } // #run
+}; // class EveryWhile
+
+/*
+ * Schedule whose Events are Fixed at Compile Time (see the Events above). The
+ * list is unrolled through inheritance, so #loop compiles down to the events'
+ * checks in order as straight-line code with no heap use at all.
+ */
+template <typename... Events>
+class StaticSchedule;
+
+template <>
+class StaticSchedule<>{
+public:
+    void loop(){ }
+protected:
+    void run(schedule_time_t){ }
+}; // class StaticSchedule<>
+
+template <typename E, typename... Rest>
+class StaticSchedule<E, Rest...> : public StaticSchedule<Rest...>{
+public:
+    // Function to be Executed on Every Main Loop (as fast as possible)
+    void loop(){
+        this->run(scheduleNow());
+    } // #loop
+
+protected:
+    E event;
+
+    void run(schedule_time_t now){
+        this->event.run(now);
+        StaticSchedule<Rest...>::run(now);
+    } // #run
+}; // class StaticSchedule
 #endif // SCHEDULE_H